@@ -1,148 +1,145 @@
 //Program to evaluate a boolean expression given the input values for each variable
 //Expression to solve for must be hard-coded in main
 //Prints result of the expression
+//Expressions evaluated many times should be compiled once with compileExpression and evaluated with CompiledExpression::eval
+//Expressions known when the program is written can be parsed by the C++ compiler itself with STATIC_EXPRESSION
+//packedTruthTable evaluates a compiled expression over every input assignment, 256 assignments at a time
+
+//Batch mode evaluates one expression for a stream of input vectors read from a file or stdin:
+//(run command) ("batch") (expression) (variable list seperated by spaces) ("from" to denote end of variables) (file name, or - for stdin) (optional "binary") (optional thread count)
+//Example: ./a.exe batch "~ab(c+d)" a b c d from vectors.txt
+//Text input has one vector per line with a 0 or 1 for each variable in order (spaces ignored) and prints one 0 or 1 per line
+//Binary input has ceil(n / 8) bytes per vector with variable x at bit (x % 8) of byte (x / 8), and prints results packed 8 per byte in the same bit order
 
 using namespace std;
 #include <string>
 #include <iostream>
 #include <vector>
 #include <math.h>
+#include <stdexcept>
+#include <cstdint>
+#include <fstream>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <initializer_list>
 
-struct charElement {
-    char value;
-    charElement *next;
-    charElement *prev;
-    charElement(char enValue) {
-        value = enValue;
-    }
-};
-
-
-int solve(charElement* start, charElement* end) {
-    charElement *one = start;
-    charElement *curr = start;
-    int total = 1;
-    int parenCount = 0;
-    bool add = false;
-    bool tilde = false;
-    charElement *closeParen;
-    while (curr != end->next) {
-        if (curr->value == '+') {
-            add = true;
-            curr = curr->next;
-        }
-        if (curr->value == '~') {
-            tilde = true;
-            curr = curr->next;
-        }
-        if (curr->value == '(') {
-            closeParen = curr;
-            while (closeParen != nullptr) {
-                if (closeParen->value == '(') {
-                    parenCount++;
-                }
-                else if (closeParen->value == ')') {
-                    parenCount--;
-                }
-                if (parenCount == 0) {
-                    if (add) {
-                        if (tilde) {
-                            total += ((solve(curr->next, closeParen->prev) + 1) % 2);
-                        }
-                        else {
-                            total += solve(curr->next, closeParen->prev);
-                        }
-                    }
-                    else {
-                        if (tilde) {
-                            total *= ((solve(curr->next, closeParen->prev) + 1) % 2);
-                        }
-                        else {
-                            total *= solve(curr->next, closeParen->prev);
-                        }
-                    }
-                    curr->next = closeParen->next;
-                    break;
-                }
-                closeParen = closeParen->next;
-            }
+//Evaluates an expression made only of 1, 0, +, ~ and parentheses in a single left-to-right pass
+//Each open parenthesis saves the enclosing sum and product on an explicit stack, so time is linear and nesting never recurses
+//Products bind tighter than sums, so "1+10" is 1 + (10)
+struct ParenFrame {
+    int sum;//OR of the finished products at this level
+    int product;//AND of the factors so far in the current product
+    bool negate;//Whether the parenthesized factor that opened the next level is negated
+};
+
+int solve(const string &expression) {
+    if (expression.empty()) {
+        throw invalid_argument("Empty expression");
+    }
+    vector<ParenFrame> frames;
+    int sum = 0;
+    int product = 1;
+    bool negate = false;//Pending '~' for the next factor
+    for (char c : expression) {
+        if (c == '~') {
+            negate = !negate;
         }
-        else {
-            if (curr->value == '1') {
-                if (add) {
-                    if (tilde) {
-                        total += 0;
-                    }
-                    else {
-                        total += 1;
-                    }
-                 }
-                else {
-                    if (tilde) {
-                        total *= 0;
-                    }
-                    else {
-                        total *= 1;
-                    }
-                }
-            }
-            else if (curr->value == '0') {
-                if (add) {
-                    if (tilde) {
-                        total += 1;
-                    }
-                    else {
-                        total += 0;
-                    }
-                }
-                else {
-                    if (tilde) {
-                        total *= 1;
-                    }
-                    else {
-                        total *= 0;
-                    }
-                }
+        else if (c == '0' || c == '1') {
+            product &= (c - '0') ^ negate;
+            negate = false;
+        }
+        else if (c == '+') {
+            sum |= product;
+            product = 1;
+            negate = false;
+        }
+        else if (c == '(') {
+            frames.push_back({sum, product, negate});
+            sum = 0;
+            product = 1;
+            negate = false;
+        }
+        else if (c == ')') {
+            if (frames.empty()) {
+                throw invalid_argument("Unmatched ')' in expression: " + expression);
             }
+            int value = sum | product;
+            ParenFrame frame = frames.back();
+            frames.pop_back();
+            sum = frame.sum;
+            product = frame.product & (value ^ frame.negate);
+            negate = false;
         }
-        curr = curr->next;
-        add = false;
-        tilde = false;
     }
-    if (total > 0) {
-        return 1;
-    }
-    else {
-        return 0;
+    if (!frames.empty()) {
+        throw invalid_argument("Missing ')' in expression: " + expression);
     }
+    return sum | product;
 }
 
-int makeList(string expression) {
-    charElement *curr;
-    charElement *prevCurr;
-    charElement *first;
-    charElement *last;
-    first = new charElement(expression.at(0));
-    curr = first;
-    for (int x = 1; x < expression.size(); x++) {        
-        curr->next = new charElement(expression.at(x));
-        curr = curr->next;
+//Variable names interned into dense ids, where id x is the name at index x of the list it was built from
+//Names are stored in a trie, so the longest name starting at any position is found in one pass over its characters
+class SymbolTable {
+    struct Node {
+        vector<pair<char, int>> children;//Next character and the index of its node
+        int id = -1;//Id of the name ending at this node
+    };
+    vector<Node> nodes;
+    int findChild(int node, char c) const {
+        for (const pair<char, int> &child : nodes[node].children) {
+            if (child.first == c) {
+                return child.second;
+            }
+        }
+        return -1;
     }
-    curr->next = nullptr;
-    last = curr;
 
-    curr = first;
-    first->prev = nullptr;
-    prevCurr = curr->next;
-    while (prevCurr != nullptr) {
-        prevCurr->prev = curr;
-        prevCurr = prevCurr->next;
-        curr = curr->next;
+    public:
+    SymbolTable(const vector<string> &names) {
+        nodes.emplace_back();
+        for (int x = 0; x < names.size(); x++) {
+            int node = 0;
+            for (char c : names.at(x)) {
+                int next = findChild(node, c);
+                if (next < 0) {
+                    next = nodes.size();
+                    nodes[node].children.push_back({c, next});
+                    nodes.emplace_back();
+                }
+                node = next;
+            }
+            //The first of any repeated names keeps the id, and an empty name is never matched
+            if (node != 0 && nodes[node].id < 0) {
+                nodes[node].id = x;
+            }
+        }
     }
-    return solve(first, last);
-}
+    //Returns the id of the longest name starting at pos in text and sets length to its size, or -1 if none starts there
+    int match(const string &text, int pos, int &length) const {
+        int best = -1;
+        length = 0;
+        int node = 0;
+        for (int x = pos; x < text.size(); x++) {
+            node = findChild(node, text[x]);
+            if (node < 0) {
+                break;
+            }
+            if (nodes[node].id >= 0) {
+                best = nodes[node].id;
+                length = x - pos + 1;
+            }
+        }
+        return best;
+    }
+};
 
-string makeMathExp(string expression, vector<string> inputNames, vector<int> inputVals) {
+//Variable names are looked up in a symbol table built once by the caller
+string makeMathExp(string expression, const SymbolTable &symbols, vector<int> inputVals) {
     //First turn the boolean expression into a math expression using the given inputs
     string mathExpression = "";
     
@@ -156,20 +153,17 @@ string makeMathExp(string expression, vector<string> inputNames, vector<int> inp
             }
         }
 
-        string currVar;
+        //Replace the longest variable name at each position with its value
+        //Any other character that is not part of the expression syntax is dropped
         string newExpression = "";
+        int length;
         for (int x = 0; x < mathExpression.size(); x++) {  
-            if (mathExpression.at(x) != '(' && mathExpression.at(x) != ')' && mathExpression.at(x) != '1' && mathExpression.at(x) != '0' && mathExpression.at(x) != '+' && mathExpression.at(x) != '~') {
-                currVar += mathExpression.at(x);
-                for (int y = 0; y < inputNames.size(); y++) {
-                    if (currVar == inputNames.at(y)) {
-                        newExpression += to_string(inputVals.at(y));
-                        currVar = "";
-                        break;
-                    }
-                }
+            int id = symbols.match(mathExpression, x, length);
+            if (id >= 0) {
+                newExpression += inputVals.at(id) ? '1' : '0';
+                x += length - 1;
             }
-            else {
+            else if (mathExpression.at(x) == '(' || mathExpression.at(x) == ')' || mathExpression.at(x) == '1' || mathExpression.at(x) == '0' || mathExpression.at(x) == '+' || mathExpression.at(x) == '~') {
                 newExpression += mathExpression.at(x);
             }
         }
@@ -177,11 +171,812 @@ string makeMathExp(string expression, vector<string> inputNames, vector<int> inp
         return newExpression;
 };
 
+string makeMathExp(string expression, vector<string> inputNames, vector<int> inputVals) {
+    return makeMathExp(expression, SymbolTable(inputNames), inputVals);
+};
+
 int eval(string expression, vector<string> inputNames, vector<int> inputVals) {
-    return makeList(makeMathExp(expression, inputNames, inputVals));
+    return solve(makeMathExp(expression, inputNames, inputVals));
+};
+
+//Compiled expression code below
+//Parses an expression once into postfix instructions over integer variable slots
+//Grammar: terms separated by '+' are OR'ed, adjacent factors are AND'ed, '~' negates the factor after it
+//Products bind tighter than sums, so "a+bc" is a + (bc)
+enum OpCode {PUSH_VAR, PUSH_CONST, NOT_OP, AND_OP, OR_OP};
+
+struct Instruction {
+    OpCode op;
+    int arg;//Variable slot for PUSH_VAR, constant value for PUSH_CONST
+};
+
+//Four machine words evaluated together, holding 256 input assignments (one per bit)
+//Plain word operations so the compiler can map them onto vector registers
+struct WordBlock {
+    uint64_t w[4];
+    WordBlock operator&(const WordBlock &other) const {
+        return {{w[0] & other.w[0], w[1] & other.w[1], w[2] & other.w[2], w[3] & other.w[3]}};
+    }
+    WordBlock operator|(const WordBlock &other) const {
+        return {{w[0] | other.w[0], w[1] | other.w[1], w[2] | other.w[2], w[3] | other.w[3]}};
+    }
+    WordBlock operator~() const {
+        return {{~w[0], ~w[1], ~w[2], ~w[3]}};
+    }
 };
 
-int main() {
+struct CompiledExpression {
+    vector<Instruction> code;
+    vector<int> stack;//Sized at compile time to the deepest point of the expression so eval never allocates
+    int varCount = 0;
+
+    //Evaluates the expression for one input assignment, inputVals is indexed by variable slot
+    int eval(const vector<int> &inputVals) {
+        int top = -1;
+        for (const Instruction &instruction : code) {
+            switch (instruction.op) {
+                case PUSH_VAR:
+                    stack[++top] = (inputVals[instruction.arg] != 0);
+                    break;
+                case PUSH_CONST:
+                    stack[++top] = instruction.arg;
+                    break;
+                case NOT_OP:
+                    stack[top] = !stack[top];
+                    break;
+                case AND_OP:
+                    top--;
+                    stack[top] = stack[top] & stack[top + 1];
+                    break;
+                case OR_OP:
+                    top--;
+                    stack[top] = stack[top] | stack[top + 1];
+                    break;
+            }
+        }
+        return stack[0];
+    }
+
+    //Evaluates the expression for a whole lane of assignments at once, bit i of every input lane belongs to assignment i
+    //laneStack must hold at least stack.size() entries
+    template <class Word>
+    Word evalLanes(const Word *inputLanes, Word *laneStack) const {
+        int top = -1;
+        for (const Instruction &instruction : code) {
+            switch (instruction.op) {
+                case PUSH_VAR:
+                    laneStack[++top] = inputLanes[instruction.arg];
+                    break;
+                case PUSH_CONST:
+                    laneStack[++top] = instruction.arg ? ~Word{} : Word{};
+                    break;
+                case NOT_OP:
+                    laneStack[top] = ~laneStack[top];
+                    break;
+                case AND_OP:
+                    top--;
+                    laneStack[top] = laneStack[top] & laneStack[top + 1];
+                    break;
+                case OR_OP:
+                    top--;
+                    laneStack[top] = laneStack[top] | laneStack[top + 1];
+                    break;
+            }
+        }
+        return laneStack[0];
+    }
+};
+
+class ExpressionCompiler {
+    string expression;
+    SymbolTable symbols;
+    int varCount;
+    int pos = 0;
+    CompiledExpression *result;
+
+    char peek() {
+        return pos < expression.size() ? expression.at(pos) : '\0';
+    }
+    void emit(OpCode op, int arg) {
+        result->code.push_back({op, arg});
+    }
+    //Finds the longest input name starting at the current position, so names sharing a prefix are not ambiguous
+    int matchVariable() {
+        int length;
+        int slot = symbols.match(expression, pos, length);
+        pos += length;
+        return slot;
+    }
+    //A parenthesis level saved while the expression inside it is parsed
+    struct ParseLevel {
+        int negations;//Number of '~' before the '(', applied when it closes
+        bool hasFactor;//Whether the enclosing product already had a factor before the '('
+        bool hasProduct;//Whether the enclosing sum already had a finished product before the '('
+    };
+    //Parses the whole expression in one loop, each '(' saving the enclosing product and sum on an explicit stack as ParenFrame does,
+    //so deeply nested expressions never recurse and only the stack of levels grows
+    void parseSum() {
+        vector<ParseLevel> levels;
+        bool hasFactor = false;
+        bool hasProduct = false;
+        while (true) {
+            int negations = 0;
+            while (peek() == '~') {
+                pos++;
+                negations++;
+            }
+            if (peek() == '(') {
+                pos++;
+                levels.push_back({negations, hasFactor, hasProduct});
+                hasFactor = false;
+                hasProduct = false;
+                continue;
+            }
+            int slot = matchVariable();
+            if (slot >= 0) {
+                emit(PUSH_VAR, slot);
+            }
+            else if (peek() == '0' || peek() == '1') {
+                emit(PUSH_CONST, peek() - '0');
+                pos++;
+            }
+            else {
+                throw invalid_argument("Unexpected '" + string(1, peek()) + "' at position " + to_string(pos) + " in expression: " + expression);
+            }
+            for (int x = 0; x < negations; x++) {
+                emit(NOT_OP, 0);
+            }
+            //The factor is finished, along with every product, sum and parenthesis it ends
+            while (true) {
+                if (hasFactor) {
+                    emit(AND_OP, 0);
+                }
+                hasFactor = true;
+                if (pos < expression.size() && peek() != '+' && peek() != ')') {
+                    break;
+                }
+                if (hasProduct) {
+                    emit(OR_OP, 0);
+                }
+                hasProduct = true;
+                hasFactor = false;
+                if (peek() == '+') {
+                    pos++;
+                    break;
+                }
+                if (levels.empty()) {
+                    return;
+                }
+                if (peek() != ')') {
+                    throw invalid_argument("Missing ')' in expression: " + expression);
+                }
+                pos++;
+                ParseLevel level = levels.back();
+                levels.pop_back();
+                for (int x = 0; x < level.negations; x++) {
+                    emit(NOT_OP, 0);
+                }
+                hasFactor = level.hasFactor;
+                hasProduct = level.hasProduct;
+            }
+        }
+    }
+
+    public:
+    ExpressionCompiler(string expression, vector<string> inputNames) : symbols(inputNames) {
+        //Eliminate whitespace
+        for (char c : expression) {
+            if (c != ' ') {
+                this->expression += c;
+            }
+        }
+        varCount = inputNames.size();
+    }
+    void compile(CompiledExpression *compiled) {
+        result = compiled;
+        result->varCount = varCount;
+        parseSum();
+        if (pos != expression.size()) {
+            throw invalid_argument("Unmatched ')' in expression: " + expression);
+        }
+        //Size the evaluation stack to the deepest point reached by the instructions
+        int depth = 0;
+        int maxDepth = 0;
+        for (const Instruction &instruction : result->code) {
+            if (instruction.op == PUSH_VAR || instruction.op == PUSH_CONST) {
+                depth++;
+            }
+            else if (instruction.op != NOT_OP) {
+                depth--;
+            }
+            maxDepth = max(maxDepth, depth);
+        }
+        result->stack.assign(maxDepth, 0);
+    }
+};
+
+CompiledExpression compileExpression(string expression, vector<string> inputNames) {
+    CompiledExpression compiled;
+    ExpressionCompiler(expression, inputNames).compile(&compiled);
+    return compiled;
+}
+
+//Bit patterns of the six lowest row-index bits within one 64-row word
+const uint64_t LOW_ROW_PATTERNS[6] = {
+    0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+    0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull
+};
+
+//Value of input variable var for the 64 rows stored in word wordIndex
+//Rows are in ascending binary order with the first variable as the most significant bit
+uint64_t inputWord(int var, int varCount, uint64_t wordIndex) {
+    int bit = varCount - 1 - var;
+    if (bit < 6) {
+        return LOW_ROW_PATTERNS[bit];
+    }
+    return ((wordIndex >> (bit - 6)) & 1) ? ~0ull : 0ull;
+}
+
+//Evaluates a compiled expression over all 2^n input assignments
+//Returns the output column packed 64 rows per word, row r is bit (r % 64) of word (r / 64)
+vector<uint64_t> packedTruthTable(const CompiledExpression &compiled) {
+    int varCount = compiled.varCount;
+    uint64_t rowCount = 1ull << varCount;
+    uint64_t wordCount = (rowCount + 63) / 64;
+    vector<uint64_t> table(wordCount);
+    int stackSize = max((int) compiled.stack.size(), 1);
+    uint64_t word = 0;
+    if (wordCount >= 4) {
+        vector<WordBlock> inputLanes(varCount);
+        vector<WordBlock> laneStack(stackSize);
+        for (; word < wordCount; word += 4) {
+            for (int x = 0; x < varCount; x++) {
+                for (int y = 0; y < 4; y++) {
+                    inputLanes[x].w[y] = inputWord(x, varCount, word + y);
+                }
+            }
+            WordBlock result = compiled.evalLanes(inputLanes.data(), laneStack.data());
+            for (int y = 0; y < 4; y++) {
+                table[word + y] = result.w[y];
+            }
+        }
+    }
+    else {
+        vector<uint64_t> inputLanes(varCount);
+        vector<uint64_t> laneStack(stackSize);
+        for (; word < wordCount; word++) {
+            for (int x = 0; x < varCount; x++) {
+                inputLanes[x] = inputWord(x, varCount, word);
+            }
+            table[word] = compiled.evalLanes(inputLanes.data(), laneStack.data());
+        }
+    }
+    //Clear the unused bits of a table with fewer than 64 rows
+    if (rowCount < 64) {
+        table[0] &= (1ull << rowCount) - 1;
+    }
+    return table;
+}
+//Compiled expression code above
+
+//Compile-time expression code below
+//STATIC_EXPRESSION parses a fixed expression while the program is being compiled and yields an object whose type is the expression tree
+//Evaluating it is straight-line code with no parsing, instruction dispatch or stack, for checkers of expressions known ahead of time
+//Example: auto check = STATIC_EXPRESSION("~ab(c+d)", "a b c d"); check({0, 1, 1, 0});
+//The variable list is seperated by spaces, names follow the same longest-match rule as compileExpression, and errors fail the build
+template <int Slot>
+struct VarNode {
+    static bool test(const int *inputs) {
+        return inputs[Slot] != 0;
+    }
+    template <class Word>
+    static Word lanes(const Word *inputs) {
+        return inputs[Slot];
+    }
+};
+
+template <int Value>
+struct ConstNode {
+    static bool test(const int *) {
+        return Value;
+    }
+    template <class Word>
+    static Word lanes(const Word *) {
+        return Value ? ~Word{} : Word{};
+    }
+};
+
+template <class Operand>
+struct NotNode {
+    static bool test(const int *inputs) {
+        return !Operand::test(inputs);
+    }
+    template <class Word>
+    static Word lanes(const Word *inputs) {
+        return ~Operand::lanes(inputs);
+    }
+};
+
+template <class Left, class Right>
+struct AndNode {
+    static bool test(const int *inputs) {
+        return Left::test(inputs) & Right::test(inputs);
+    }
+    template <class Word>
+    static Word lanes(const Word *inputs) {
+        return Left::lanes(inputs) & Right::lanes(inputs);
+    }
+};
+
+template <class Left, class Right>
+struct OrNode {
+    static bool test(const int *inputs) {
+        return Left::test(inputs) | Right::test(inputs);
+    }
+    template <class Word>
+    static Word lanes(const Word *inputs) {
+        return Left::lanes(inputs) | Right::lanes(inputs);
+    }
+};
+
+constexpr int staticLength(const char *text) {
+    int length = 0;
+    while (text[length] != '\0') {
+        length++;
+    }
+    return length;
+}
+
+constexpr int skipSpaces(const char *text, int pos) {
+    while (text[pos] == ' ') {
+        pos++;
+    }
+    return pos;
+}
+
+//Slot and length of the longest variable name starting at pos, slot is -1 if there is none
+struct StaticMatch {
+    int slot;
+    int length;
+};
+
+constexpr StaticMatch staticMatchVariable(const char *expression, int pos, const char *variables) {
+    StaticMatch best = {-1, 0};
+    int slot = 0;
+    int start = skipSpaces(variables, 0);
+    while (variables[start] != '\0') {
+        int length = 0;
+        while (variables[start + length] != '\0' && variables[start + length] != ' ') {
+            length++;
+        }
+        bool matches = length > best.length;
+        for (int x = 0; matches && x < length; x++) {
+            matches = expression[pos + x] == variables[start + x];
+        }
+        if (matches) {
+            best = {slot, length};
+        }
+        slot++;
+        start = skipSpaces(variables, start + length);
+    }
+    return best;
+}
+
+constexpr int staticVariableCount(const char *variables) {
+    int count = 0;
+    int start = skipSpaces(variables, 0);
+    while (variables[start] != '\0') {
+        while (variables[start] != '\0' && variables[start] != ' ') {
+            start++;
+        }
+        count++;
+        start = skipSpaces(variables, start);
+    }
+    return count;
+}
+
+enum StaticFactorKind {STATIC_NOT, STATIC_PAREN, STATIC_VAR, STATIC_CONST, STATIC_ERROR};
+
+template <class Text>
+constexpr StaticFactorKind staticFactorKind(int pos) {
+    return Text::expression()[pos] == '~' ? STATIC_NOT
+        : Text::expression()[pos] == '(' ? STATIC_PAREN
+        : staticMatchVariable(Text::expression(), pos, Text::variables()).slot >= 0 ? STATIC_VAR
+        : (Text::expression()[pos] == '0' || Text::expression()[pos] == '1') ? STATIC_CONST
+        : STATIC_ERROR;
+}
+
+//Each parse step names the tree it built as type and the position after it as end
+template <class Text, int Pos>
+struct ParseStaticSum;
+
+template <class Text, int Pos, StaticFactorKind Kind = staticFactorKind<Text>(skipSpaces(Text::expression(), Pos))>
+struct ParseStaticFactor;
+
+template <class Text, int Pos>
+struct ParseStaticFactor<Text, Pos, STATIC_NOT> {
+    typedef ParseStaticFactor<Text, skipSpaces(Text::expression(), Pos) + 1> operand;
+    typedef NotNode<typename operand::type> type;
+    static constexpr int end = operand::end;
+};
+
+template <class Text, int Pos>
+struct ParseStaticFactor<Text, Pos, STATIC_PAREN> {
+    typedef ParseStaticSum<Text, skipSpaces(Text::expression(), Pos) + 1> inner;
+    static_assert(Text::expression()[skipSpaces(Text::expression(), inner::end)] == ')', "Missing ')' in static expression");
+    typedef typename inner::type type;
+    static constexpr int end = skipSpaces(Text::expression(), inner::end) + (Text::expression()[skipSpaces(Text::expression(), inner::end)] == ')');
+};
+
+template <class Text, int Pos>
+struct ParseStaticFactor<Text, Pos, STATIC_VAR> {
+    static constexpr StaticMatch match = staticMatchVariable(Text::expression(), skipSpaces(Text::expression(), Pos), Text::variables());
+    typedef VarNode<match.slot> type;
+    static constexpr int end = skipSpaces(Text::expression(), Pos) + match.length;
+};
+
+template <class Text, int Pos>
+struct ParseStaticFactor<Text, Pos, STATIC_CONST> {
+    typedef ConstNode<Text::expression()[skipSpaces(Text::expression(), Pos)] - '0'> type;
+    static constexpr int end = skipSpaces(Text::expression(), Pos) + 1;
+};
+
+template <class Text, int Pos>
+struct ParseStaticFactor<Text, Pos, STATIC_ERROR> {
+    static_assert(Pos < 0, "Unexpected character in static expression");
+    typedef ConstNode<0> type;
+    static constexpr int end = staticLength(Text::expression());
+};
+
+template <class Text>
+constexpr bool endsProduct(int pos) {
+    return Text::expression()[skipSpaces(Text::expression(), pos)] == '\0'
+        || Text::expression()[skipSpaces(Text::expression(), pos)] == '+'
+        || Text::expression()[skipSpaces(Text::expression(), pos)] == ')';
+}
+
+//Folds the remaining factors of a product onto Product
+template <class Text, int Pos, class Product, bool Done = endsProduct<Text>(Pos)>
+struct ParseStaticProductTail {
+    typedef ParseStaticFactor<Text, Pos> next;
+    typedef ParseStaticProductTail<Text, next::end, AndNode<Product, typename next::type>> rest;
+    typedef typename rest::type type;
+    static constexpr int end = rest::end;
+};
+
+template <class Text, int Pos, class Product>
+struct ParseStaticProductTail<Text, Pos, Product, true> {
+    typedef Product type;
+    static constexpr int end = Pos;
+};
+
+template <class Text, int Pos>
+struct ParseStaticProduct {
+    typedef ParseStaticFactor<Text, Pos> first;
+    typedef ParseStaticProductTail<Text, first::end, typename first::type> rest;
+    typedef typename rest::type type;
+    static constexpr int end = rest::end;
+};
+
+template <class Text>
+constexpr bool continuesSum(int pos) {
+    return Text::expression()[skipSpaces(Text::expression(), pos)] == '+';
+}
+
+//Folds the remaining products of a sum onto Sum
+template <class Text, int Pos, class Sum, bool More = continuesSum<Text>(Pos)>
+struct ParseStaticSumTail {
+    typedef ParseStaticProduct<Text, skipSpaces(Text::expression(), Pos) + 1> next;
+    typedef ParseStaticSumTail<Text, next::end, OrNode<Sum, typename next::type>> rest;
+    typedef typename rest::type type;
+    static constexpr int end = rest::end;
+};
+
+template <class Text, int Pos, class Sum>
+struct ParseStaticSumTail<Text, Pos, Sum, false> {
+    typedef Sum type;
+    static constexpr int end = Pos;
+};
+
+template <class Text, int Pos>
+struct ParseStaticSum {
+    typedef ParseStaticProduct<Text, Pos> first;
+    typedef ParseStaticSumTail<Text, first::end, typename first::type> rest;
+    typedef typename rest::type type;
+    static constexpr int end = rest::end;
+};
+
+//Expression parsed at compile time, Text supplies the expression and variable list as constexpr strings
+template <class Text>
+struct StaticExpression {
+    typedef ParseStaticSum<Text, 0> parsed;
+    static_assert(skipSpaces(Text::expression(), parsed::end) == staticLength(Text::expression()), "Unmatched ')' in static expression");
+    typedef typename parsed::type Tree;
+    static constexpr int varCount = staticVariableCount(Text::variables());
+
+    //Evaluates one input assignment, inputs is indexed by variable slot
+    bool operator()(const int *inputs) const {
+        return Tree::test(inputs);
+    }
+    bool operator()(initializer_list<int> inputs) const {
+        if (inputs.size() != varCount) {
+            throw invalid_argument("Expression has " + to_string(varCount) + " variables but " + to_string(inputs.size()) + " values were given");
+        }
+        return Tree::test(inputs.begin());
+    }
+    //Evaluates a lane of assignments at once, bit i of every input lane belongs to assignment i
+    template <class Word>
+    Word lanes(const Word *inputLanes) const {
+        return Tree::template lanes<Word>(inputLanes);
+    }
+};
+
+#define STATIC_EXPRESSION(expressionText, variableText) \
+    ([] { \
+        struct Text { \
+            static constexpr const char *expression() {return expressionText;} \
+            static constexpr const char *variables() {return variableText;} \
+        }; \
+        return StaticExpression<Text>(); \
+    }())
+//Compile-time expression code above
+
+//Batch evaluation code below
+const int BATCH_CHUNK_VECTORS = 1 << 16;//Vectors per binary chunk, a multiple of 64
+const int BATCH_CHUNK_BYTES = 1 << 20;//Approximate bytes per text chunk, always cut at the end of a line
+
+//Fixed set of worker threads running submitted tasks, started in submission order but finishing in any order
+//Callers that need ordered output keep the returned futures in order, as evaluateBatch does
+class ThreadPool {
+    vector<thread> workers;
+    deque<function<void()>> tasks;
+    mutex lock;
+    condition_variable ready;
+    bool stopping = false;
+
+    void work() {
+        while (true) {
+            function<void()> task;
+            {
+                unique_lock<mutex> guard(lock);
+                ready.wait(guard, [this] {return stopping || !tasks.empty();});
+                if (tasks.empty()) {
+                    return;
+                }
+                task = move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    public:
+    ThreadPool(int threadCount) {
+        for (int x = 0; x < threadCount; x++) {
+            workers.emplace_back(&ThreadPool::work, this);
+        }
+    }
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (thread &worker : workers) {
+            worker.join();
+        }
+    }
+    //Queues a task and returns a future for its result
+    template <class Result>
+    future<Result> submit(function<Result()> job) {
+        shared_ptr<packaged_task<Result()>> task = make_shared<packaged_task<Result()>>(job);
+        {
+            lock_guard<mutex> guard(lock);
+            tasks.push_back([task] {(*task)();});
+        }
+        ready.notify_one();
+        return task->get_future();
+    }
+};
+
+//Evaluates one group of up to 64 vectors held in inputLanes and appends the results
+void writeLaneResults(const CompiledExpression &compiled, vector<uint64_t> &inputLanes, vector<uint64_t> &laneStack, int count, bool binary, string &results) {
+    uint64_t result = compiled.evalLanes(inputLanes.data(), laneStack.data());
+    if (count < 64) {
+        result &= (1ull << count) - 1;//Unused lanes hold garbage, keep them out of the last byte
+    }
+    if (binary) {
+        for (int x = 0; x < count; x += 8) {
+            results += (char) ((result >> x) & 0xFF);
+        }
+    }
+    else {
+        for (int x = 0; x < count; x++) {
+            results += ((result >> x) & 1) ? "1\n" : "0\n";
+        }
+    }
+    fill(inputLanes.begin(), inputLanes.end(), 0);
+}
+
+//Evaluates every vector in one chunk of input, 64 vectors at a time, and returns the chunk's output
+string evaluateChunk(const CompiledExpression &compiled, const string &data, bool binary) {
+    int varCount = compiled.varCount;
+    vector<uint64_t> inputLanes(varCount);
+    vector<uint64_t> laneStack(max((int) compiled.stack.size(), 1));
+    string results;
+    int count = 0;//Vectors in the current group of 64
+    if (binary) {
+        int vectorBytes = (varCount + 7) / 8;
+        //Chunks are whole vectors, so only the input's last chunk can end part way through one
+        if (vectorBytes > 0 && data.size() % vectorBytes != 0) {
+            throw invalid_argument("Input ends with a partial vector of " + to_string(data.size() % vectorBytes) + " bytes, expected " + to_string(vectorBytes));
+        }
+        for (size_t offset = 0; offset + vectorBytes <= data.size(); offset += vectorBytes) {
+            for (int x = 0; x < varCount; x++) {
+                inputLanes[x] |= (uint64_t) ((data[offset + x / 8] >> (x % 8)) & 1) << count;
+            }
+            if (++count == 64) {
+                writeLaneResults(compiled, inputLanes, laneStack, count, binary, results);
+                count = 0;
+            }
+        }
+    }
+    else {
+        int var = 0;
+        for (size_t x = 0; x <= data.size(); x++) {
+            char c = x < data.size() ? data[x] : '\n';
+            if (c == '0' || c == '1') {
+                if (var == varCount) {
+                    throw invalid_argument("Input vector has more than " + to_string(varCount) + " values");
+                }
+                inputLanes[var++] |= (uint64_t) (c - '0') << count;
+            }
+            else if (c == '\n') {
+                if (var == 0) {
+                    continue;//Blank line
+                }
+                if (var != varCount) {
+                    throw invalid_argument("Input vector has " + to_string(var) + " values, expected " + to_string(varCount));
+                }
+                var = 0;
+                if (++count == 64) {
+                    writeLaneResults(compiled, inputLanes, laneStack, count, binary, results);
+                    count = 0;
+                }
+            }
+            else if (c != ' ' && c != '\t' && c != '\r') {
+                throw invalid_argument("Unexpected '" + string(1, c) + "' in input vector");
+            }
+        }
+    }
+    if (count > 0) {
+        writeLaneResults(compiled, inputLanes, laneStack, count, binary, results);
+    }
+    return results;
+}
+
+//Reads the next chunk of input, returns false once the input is exhausted
+bool readChunk(istream &input, int varCount, bool binary, string &data) {
+    if (binary) {
+        data.resize((size_t) BATCH_CHUNK_VECTORS * ((varCount + 7) / 8));
+        input.read(&data[0], data.size());
+        data.resize(input.gcount());
+    }
+    else {
+        data.resize(BATCH_CHUNK_BYTES);
+        input.read(&data[0], data.size());
+        data.resize(input.gcount());
+        //Finish the line the chunk ends in so no vector is split across chunks
+        string rest;
+        if (!data.empty() && data.back() != '\n' && getline(input, rest)) {
+            data += rest;
+        }
+    }
+    return !data.empty();
+}
+
+//Streams input vectors through the expression on threadCount workers and writes results in input order
+void evaluateBatch(const CompiledExpression &compiled, istream &input, ostream &output, bool binary, int threadCount) {
+    ThreadPool pool(threadCount);
+    deque<future<string>> pending;//Chunks being evaluated, oldest first
+    string data;
+    while (readChunk(input, compiled.varCount, binary, data)) {
+        shared_ptr<string> chunk = make_shared<string>(move(data));
+        pending.push_back(pool.submit<string>([&compiled, chunk, binary] {return evaluateChunk(compiled, *chunk, binary);}));
+        //Bound the chunks in flight so memory use does not grow with the input
+        if (pending.size() >= 2 * threadCount) {
+            output << pending.front().get();
+            pending.pop_front();
+        }
+    }
+    while (!pending.empty()) {
+        output << pending.front().get();
+        pending.pop_front();
+    }
+    output.flush();
+}
+
+//Runs batch mode from the command line arguments following "batch"
+int runBatch(int argc, char* argv[]) {
+    string usage = string("Usage: ") + argv[0] + " batch (expression) (variables) from (file or -) [binary] [threads]";
+    if (argc < 5) {
+        cerr << usage << endl;
+        return 1;
+    }
+    string expression = argv[2];
+    vector<string> inputNames;
+    int x = 3;
+    while (x < argc && string(argv[x]) != "from") {
+        inputNames.push_back(argv[x++]);
+    }
+    if (x + 1 >= argc) {
+        cerr << "Missing input file after the variable list" << endl;
+        return 1;
+    }
+    string fileName = argv[x + 1];
+    bool binary = false;
+    int threadCount = max((int) thread::hardware_concurrency(), 1);
+    for (x += 2; x < argc; x++) {
+        if (string(argv[x]) == "binary") {
+            binary = true;
+        }
+        else {
+            size_t length = 0;
+            try {
+                threadCount = max(stoi(argv[x], &length), 1);
+            }
+            catch (exception &) {
+                length = 0;
+            }
+            if (length == 0 || argv[x][length] != '\0') {
+                cerr << "Bad thread count " << argv[x] << endl << usage << endl;
+                return 1;
+            }
+        }
+    }
+    try {
+        CompiledExpression compiled = compileExpression(expression, inputNames);
+        ios::sync_with_stdio(false);
+        if (fileName == "-") {
+            evaluateBatch(compiled, cin, cout, binary, threadCount);
+        }
+        else {
+            ifstream input(fileName, ios::binary);
+            if (!input) {
+                cerr << "Cannot open " << fileName << endl;
+                return 1;
+            }
+            evaluateBatch(compiled, input, cout, binary, threadCount);
+        }
+    }
+    catch (exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
+//Batch evaluation code above
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "batch") {
+        return runBatch(argc, argv);
+    }
+
     //Argument order: (expression), (variables), (corresponding variable values)
     cout << eval("~ab(c+d)", {"a", "b", "c", "d"}, {0, 1, 1, 0}) << endl;
+
+    //Same expression compiled once, then evaluated for any number of input assignments
+    CompiledExpression compiled = compileExpression("~ab(c+d)", {"a", "b", "c", "d"});
+    cout << compiled.eval({0, 1, 1, 0}) << endl;
+
+    //Same expression parsed while this program was compiled
+    auto staticCompiled = STATIC_EXPRESSION("~ab(c+d)", "a b c d");
+    cout << staticCompiled({0, 1, 1, 0}) << endl;
+
+    //Every row of its truth table, evaluated bit-parallel
+    vector<uint64_t> table = packedTruthTable(compiled);
+    for (int x = 0; x < 16; x++) {
+        cout << ((table[0] >> x) & 1) << flush;
+    }
+    cout << endl;
 }
\ No newline at end of file
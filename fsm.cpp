@@ -7,390 +7,2395 @@ using namespace std;
 #include <iostream>
 #include <vector>
 #include <math.h>
+#include <stdexcept>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <chrono>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstring>
+#include <sstream>
+#include <atomic>
 
 //kmap soplver code below
-struct BoolVar {
+int popcount64(uint64_t word) {
+#ifdef __GNUC__
+    return __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (word * 0x0101010101010101ull) >> 56;
+#endif
+}
+
+//A single column in a truth table, packed 64 rows per word as two bit planes
+//A row is 1 when set in on, don't care when set in dontCare and 0 otherwise, the planes never share a row
+struct TruthColumn {
     string name;
-    bool sign;
-    bool include = true;//Indicates whether this variable is eliminated by the kmap
-    BoolVar(string name, int sign) {
+    uint64_t rowCount;
+    vector<uint64_t> on;
+    vector<uint64_t> dontCare;
+    TruthColumn(string name, uint64_t rowCount) {
         this->name = name;
-        this->sign = sign;
+        this->rowCount = rowCount;
+        on.assign((rowCount + 63) / 64, 0);
+        dontCare.assign(on.size(), 0);
     }
-    void print() {
-        if (!sign) {
-            cout << "~" << flush;
+    //Returns the value of a row (0, 1 or 2 for don't care)
+    int valueAt(uint64_t row) const {
+        if ((dontCare[row / 64] >> (row % 64)) & 1) {
+            return 2;
+        }
+        return (on[row / 64] >> (row % 64)) & 1;
+    }
+    void setValue(uint64_t row, int value) {
+        uint64_t bit = 1ull << (row % 64);
+        on[row / 64] = value == 1 ? on[row / 64] | bit : on[row / 64] & ~bit;
+        dontCare[row / 64] = value == 2 ? dontCare[row / 64] | bit : dontCare[row / 64] & ~bit;
+    }
+    //Rows whose value equals value, packed 64 rows per word with the rows past rowCount clear
+    vector<uint64_t> rowsWith(int value) const {
+        if (value == 1) {
+            return on;
+        }
+        if (value == 2) {
+            return dontCare;
+        }
+        vector<uint64_t> rows(on.size());
+        for (uint64_t x = 0; x < rows.size(); x++) {
+            rows[x] = ~(on[x] | dontCare[x]);
+        }
+        if (rowCount % 64 != 0) {
+            rows.back() &= (1ull << (rowCount % 64)) - 1;
+        }
+        return rows;
+    }
+};
+
+//A truth table of a single output over its inputs in binary ascending order
+//Only the output is stored, input columns follow from the row index and are built on demand
+class TruthTable {
+    vector<string> inputNames;//Input names, most significant row bit first
+    public:
+    unique_ptr<TruthColumn> output;
+    //Constructor to build truth table out of a string representing a boolean function
+    TruthTable(string expression) {
+
+    }
+    //Constructor from one output value per row (0, 1 or 2 for don't care), assumes output is in binary ascending order
+    TruthTable(vector<string> inputNames, string outputName, const vector<int> &outputs) {
+        this->inputNames = inputNames;
+        output.reset(new TruthColumn(outputName, 1ull << inputNames.size()));
+        for (uint64_t x = 0; x < outputs.size() && x < output->rowCount; x++) {
+            output->setValue(x, outputs[x]);
+        }
+    }
+    //Constructor from packed on and don't care planes, don't care wins where both are set
+    TruthTable(vector<string> inputNames, string outputName, const vector<uint64_t> &on, const vector<uint64_t> &dontCare) {
+        this->inputNames = inputNames;
+        output.reset(new TruthColumn(outputName, 1ull << inputNames.size()));
+        for (uint64_t x = 0; x < output->on.size(); x++) {
+            output->dontCare[x] = x < dontCare.size() ? dontCare[x] : 0;
+            output->on[x] = (x < on.size() ? on[x] : 0) & ~output->dontCare[x];
+        }
+        if (output->rowCount % 64 != 0) {
+            output->on.back() &= (1ull << (output->rowCount % 64)) - 1;
+            output->dontCare.back() &= (1ull << (output->rowCount % 64)) - 1;
+        }
+    }
+    int inputCount() const {
+        return inputNames.size();
+    }
+    string inputName(int var) const {
+        return inputNames.at(var);
+    }
+    uint64_t rowCount() const {
+        return output->rowCount;
+    }
+    //Returns value of input var at a row, read straight from the row index
+    int inputAt(int var, uint64_t row) const {
+        return (row >> (inputNames.size() - 1 - var)) & 1;
+    }
+    //Returns value of output at an entered index
+    int outputAt(uint64_t index) const {
+        if (index >= output->rowCount) {
+            throw out_of_range("Row " + to_string(index) + " is outside the truth table");
+        }
+        return output->valueAt(index);
+    }
+    //Rows whose output equals value (0, 1 or 2 for don't care), packed 64 rows per word
+    vector<uint64_t> packedOutput(int value) const {
+        return output->rowsWith(value);
+    }
+};
+
+//Bit patterns of the six lowest row-index bits within one 64-row word
+const uint64_t LOW_ROW_PATTERNS[6] = {
+    0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+    0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull
+};
+
+//A group of cells stored as a cube: every cell m with (m & ~mask) == value
+//Bit (varCount - 1 - y) of a cell holds variable y, so cells adjacent in the kmap differ in exactly one bit
+struct Group {
+    uint64_t value;//Bits shared by every cell in the group, zero wherever mask is set
+    uint64_t mask;//Bits of the variables eliminated by the group
+    Group(uint64_t value, uint64_t mask) {
+        this->value = value;
+        this->mask = mask;
+    }
+    uint64_t size() const {
+        return 1ull << popcount64(mask);
+    }
+    //The group doubled across the bits in shift
+    Group extend(uint64_t shift) const {
+        return Group(value & ~shift, mask | shift);
+    }
+    bool operator==(const Group &other) const {
+        return value == other.value && mask == other.mask;
+    }
+    //Calls visit with every cell in the group by walking the subsets of mask
+    template <class Visit>
+    void forEach(Visit visit) const {
+        uint64_t bits = 0;
+        do {
+            visit(value | bits);
+            bits = (bits - mask) & mask;
+        } while (bits != 0);
+    }
+    //Calls visit(word, bits) with every word of a packed table the group meets and the bits of its cells in that word
+    //The low six bits of a cell pick its bit within a word and the rest pick the word
+    template <class Visit>
+    void forEachWord(Visit visit) const {
+        uint64_t pattern = ~0ull;
+        for (int bit = 0; bit < 6; bit++) {
+            if (((mask >> bit) & 1) == 0) {
+                pattern &= ((value >> bit) & 1) ? LOW_ROW_PATTERNS[bit] : ~LOW_ROW_PATTERNS[bit];
+            }
+        }
+        Group(value >> 6, mask >> 6).forEach([&](uint64_t word) {visit(word, pattern);});
+    }
+
+    //For debugging purposes
+    void Print() const {
+        forEach([](uint64_t cell) {cout << cell << " " << flush;});
+        cout << endl;
+    }
+};
+
+//Statistics code below
+//Phases of solving are timed on a monotonic clock and tallied with counts of what they made, for --stats to print as JSON
+//Nothing is recorded unless a SolveStats is handed in, and built with KMAP_STATS set to 0 the timers and counts compile to nothing
+#ifndef KMAP_STATS
+#define KMAP_STATS 1
+#endif
+
+//Calls to operator new while countAllocations is set, counted by programs that replace operator new
+atomic<uint64_t> allocationCount(0);
+bool countAllocations = false;
+
+struct SolveStats {
+    struct Phase {
+        string name;
+        double seconds = 0;
+        uint64_t allocations = 0;
+        uint64_t calls = 0;
+    };
+    vector<Phase> phases;//In the order each first ran
+    vector<pair<string, uint64_t>> counters;
+
+    void addPhase(const string &name, double seconds, uint64_t allocations, uint64_t calls = 1) {
+        for (Phase &phase : phases) {
+            if (phase.name == name) {
+                phase.seconds += seconds;
+                phase.allocations += allocations;
+                phase.calls += calls;
+                return;
+            }
+        }
+        Phase phase;
+        phase.name = name;
+        phase.seconds = seconds;
+        phase.allocations = allocations;
+        phase.calls = calls;
+        phases.push_back(phase);
+    }
+    void count(const string &name, uint64_t amount) {
+        for (pair<string, uint64_t> &counter : counters) {
+            if (counter.first == name) {
+                counter.second += amount;
+                return;
+            }
+        }
+        counters.push_back(make_pair(name, amount));
+    }
+    //Adds the phases and counts of other, such as another function of a batch
+    void merge(const SolveStats &other) {
+        for (const Phase &phase : other.phases) {
+            addPhase(phase.name, phase.seconds, phase.allocations, phase.calls);
+        }
+        for (const pair<string, uint64_t> &counter : other.counters) {
+            count(counter.first, counter.second);
+        }
+    }
+    string json() const {
+        ostringstream out;
+        double total = 0;
+        uint64_t allocations = 0;
+        out << "{\"phases\": [";
+        for (int x = 0; x < phases.size(); x++) {
+            out << (x == 0 ? "" : ", ") << "{\"name\": \"" << phases[x].name << "\", \"seconds\": " << phases[x].seconds
+                << ", \"allocations\": " << phases[x].allocations << ", \"calls\": " << phases[x].calls << "}";
+            total += phases[x].seconds;
+            allocations += phases[x].allocations;
+        }
+        out << "], \"total_seconds\": " << total << ", \"total_allocations\": " << allocations << ", \"counters\": {";
+        for (int x = 0; x < counters.size(); x++) {
+            out << (x == 0 ? "" : ", ") << "\"" << counters[x].first << "\": " << counters[x].second;
+        }
+        out << "}}";
+        return out.str();
+    }
+};
+
+//Adds the time and allocations between its construction and destruction to a phase of stats, doing nothing when stats is null
+class PhaseTimer {
+    SolveStats *stats;
+    const char *name;
+    chrono::steady_clock::time_point start;
+    uint64_t allocationsAtStart;
+    public:
+    PhaseTimer(SolveStats *stats, const char *name) {
+        this->stats = stats;
+        this->name = name;
+        if (stats != nullptr) {
+            start = chrono::steady_clock::now();
+            allocationsAtStart = allocationCount.load(memory_order_relaxed);
+        }
+    }
+    ~PhaseTimer() {
+        if (stats != nullptr) {
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            stats->addPhase(name, elapsed.count(), allocationCount.load(memory_order_relaxed) - allocationsAtStart);
+        }
+    }
+};
+
+#if KMAP_STATS
+#define STATS_PHASE(stats, name) PhaseTimer phaseTimer(stats, name)
+#define STATS_COUNT(stats, name, amount) do {if ((stats) != nullptr) {(stats)->count(name, amount);}} while (false)
+#else
+#define STATS_PHASE(stats, name)
+#define STATS_COUNT(stats, name, amount)
+#endif
+//Statistics code above
+
+//Work stealing thread pool code below
+//run() hands each thread a contiguous range of the task indices, a thread takes tasks from the front of its own range
+//and once that is empty steals from the back of another thread's range, so uneven tasks still keep every thread busy
+//Callers give each task its own output and combine them in task order afterwards, so results never depend on the thread count
+class WorkPool {
+    struct Range {
+        mutex lock;
+        int begin = 0;
+        int end = 0;
+    };
+    vector<unique_ptr<Range>> ranges;//One per thread, the calling thread being the first
+    vector<thread> threads;
+    mutex lock;
+    condition_variable wake;
+    condition_variable done;
+    const function<void(int)> *task = nullptr;
+    uint64_t generation = 0;//Counts calls to run() so a waiting thread knows there is new work
+    int remaining = 0;//Threads yet to finish the current call
+    bool stopping = false;
+
+    bool take(int self, int &index) {
+        {
+            lock_guard<mutex> guard(ranges[self]->lock);
+            if (ranges[self]->begin < ranges[self]->end) {
+                index = ranges[self]->begin++;
+                return true;
+            }
+        }
+        for (int x = 1; x < ranges.size(); x++) {
+            Range &other = *ranges[(self + x) % ranges.size()];
+            lock_guard<mutex> guard(other.lock);
+            if (other.begin < other.end) {
+                index = --other.end;
+                return true;
+            }
+        }
+        return false;
+    }
+    void work(int self) {
+        int index;
+        while (take(self, index)) {
+            (*task)(index);
+        }
+    }
+    void loop(int self) {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                unique_lock<mutex> guard(lock);
+                wake.wait(guard, [&]() {return stopping || generation != seen;});
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+            work(self);
+            lock_guard<mutex> guard(lock);
+            if (--remaining == 0) {
+                done.notify_one();
+            }
+        }
+    }
+
+    public:
+    //A pool of one thread runs every task on the calling thread
+    WorkPool(int threadCount) {
+        threadCount = max(threadCount, 1);
+        for (int x = 0; x < threadCount; x++) {
+            ranges.push_back(unique_ptr<Range>(new Range()));
+        }
+        for (int x = 1; x < threadCount; x++) {
+            threads.push_back(thread(&WorkPool::loop, this, x));
+        }
+    }
+    ~WorkPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread &worker : threads) {
+            worker.join();
+        }
+    }
+    int size() const {
+        return ranges.size();
+    }
+    //Calls task(x) for every x from 0 to count - 1 and returns once all of them are done
+    void run(int count, const function<void(int)> &task) {
+        if (threads.empty()) {
+            for (int x = 0; x < count; x++) {
+                task(x);
+            }
+            return;
+        }
+        for (int x = 0; x < ranges.size(); x++) {
+            lock_guard<mutex> guard(ranges[x]->lock);
+            ranges[x]->begin = (int64_t) count * x / ranges.size();
+            ranges[x]->end = (int64_t) count * (x + 1) / ranges.size();
+        }
+        {
+            lock_guard<mutex> guard(lock);
+            this->task = &task;
+            remaining = threads.size();
+            generation++;
+        }
+        wake.notify_all();
+        work(0);
+        unique_lock<mutex> guard(lock);
+        done.wait(guard, [&]() {return remaining == 0;});
+    }
+};
+//Work stealing thread pool code above
+
+//Quine-McCluskey prime implicant code below
+//Cubes are merged a level at a time, where level k holds the cubes eliminating k variables
+//Each level is bucketed by the number of 1 bits in a cube's value, and cubes merge when they share a mask and their values differ in one bit
+//so a cube in bucket p only ever merges with bucket p + 1, and the merged cube lands in bucket p of the next level
+//Several functions of the same inputs may be handled at once, each cube carrying a mask of the outputs it is an implicant of
+//A merged cube is only an implicant of the outputs both halves are, and a half is not prime if the merged cube keeps all its outputs
+struct GroupHash {
+    size_t operator()(const Group &group) const {
+        uint64_t hash = (group.value ^ (group.mask * 0x9E3779B97F4A7C15ull)) * 0xBF58476D1CE4E5B9ull;
+        return hash ^ (hash >> 31);
+    }
+};
+
+typedef vector<vector<Group>> CubeLevel;
+typedef vector<vector<uint64_t>> CubeOutputs;
+
+//Open addressing hash table from cubes to their position in a bucket
+//Levels take millions of lookups, which a node based map spends mostly on cache misses
+class CubeTable {
+    struct Slot {
+        Group group;
+        int position;
+    };
+    vector<Slot> slots;//Each cube is kept beside its position so a probe touches one cache line
+    uint64_t slotMask = 0;
+    size_t count = 0;
+    static Group empty() {
+        return Group(~0ull, ~0ull);//Not a valid cube since value and mask never share a bit
+    }
+    void grow() {
+        vector<Slot> oldSlots;
+        oldSlots.swap(slots);
+        reset(oldSlots.size());
+        for (const Slot &slot : oldSlots) {
+            if (!(slot.group == empty())) {
+                insert(slot.group, slot.position);
+            }
+        }
+    }
+    public:
+    //Empties the table, sized so that expected cubes fit without growing
+    void reset(size_t expected) {
+        size_t capacity = 16;
+        while (capacity < 2 * expected) {
+            capacity *= 2;
+        }
+        slots.assign(capacity, Slot{empty(), -1});
+        slotMask = capacity - 1;
+        count = 0;
+    }
+    //Position stored with a cube, or -1 if it is absent
+    int find(const Group &group) const {
+        for (uint64_t x = GroupHash()(group) & slotMask; ; x = (x + 1) & slotMask) {
+            if (slots[x].group == group) {
+                return slots[x].position;
+            }
+            if (slots[x].group == empty()) {
+                return -1;
+            }
+        }
+    }
+    //Adds a cube unless it is already present, returning whether it was added
+    bool insert(const Group &group, int position) {
+        if (2 * (count + 1) > slots.size()) {
+            grow();
+        }
+        uint64_t x = GroupHash()(group) & slotMask;
+        while (!(slots[x].group == empty())) {
+            if (slots[x].group == group) {
+                return false;
+            }
+            x = (x + 1) & slotMask;
+        }
+        slots[x] = Slot{group, position};
+        count++;
+        return true;
+    }
+};
+
+//Checks whether any cell of a group is set in bits
+bool coversAny(const Group &group, const vector<uint64_t> &bits) {
+    bool covers = false;
+    group.forEach([&](uint64_t cell) {
+        covers = covers || ((bits[cell / 64] >> (cell % 64)) & 1);
+    });
+    return covers;
+}
+
+class PrimeGenerator {
+    int varCount;
+    CubeLevel level;
+    CubeOutputs levelOutputs;//Outputs of each cube of the current level, one bit per output
+    vector<CubeTable> index;//Position of each cube of the current level within its bucket
+    vector<Group> primes;
+    vector<uint64_t> primeOutputs;
+
+    //A run of cubes from one bucket of the current level, merged as one task
+    //Large buckets are split across several chunks so the work spreads evenly over the threads
+    struct Chunk {
+        int bucket;
+        int begin;
+        int end;
+        vector<Group> merged;//Cubes formed for the same bucket of the next level
+        vector<uint64_t> mergedOutputs;
+        vector<Group> primes;
+        vector<uint64_t> primeOutputs;
+    };
+    static const int chunkSize = 4096;
+
+    //Checks whether a cube covers a target of any of its outputs
+    static bool coversTarget(const Group &group, uint64_t outputs, const vector<vector<uint64_t>> &targets) {
+        for (int output = 0; output < targets.size(); output++) {
+            if (((outputs >> output) & 1) && coversAny(group, targets[output])) {
+                return true;
+            }
+        }
+        return false;
+    }
+    //Merges each cube of a chunk with its neighbours in the bucket above, and keeps it as a prime if no neighbour
+    //above or below merges with it keeping all its outputs
+    //Only writes to the chunk, so chunks may be merged at the same time
+    void mergeChunk(Chunk &chunk, const vector<vector<uint64_t>> &targets) {
+        int p = chunk.bucket;
+        uint64_t allBits = (varCount == 64) ? ~0ull : (1ull << varCount) - 1;
+        for (int x = chunk.begin; x < chunk.end; x++) {
+            const Group &group = level[p][x];
+            uint64_t outputs = levelOutputs[p][x];
+            bool merged = false;
+            //A merged cube can be formed across any bit of its mask, so it is only kept when formed across the lowest one
+            //Both halves of every implicant are present in the level below, so this still yields each merged cube exactly once
+            uint64_t lowest = group.mask & (~group.mask + 1);
+            uint64_t free = allBits & ~group.mask & ~group.value;
+            while (free != 0) {
+                uint64_t bit = free & (~free + 1);
+                free ^= bit;
+                bool kept = lowest == 0 || bit < lowest;
+                if (!kept && merged) {
+                    break;
+                }
+                int partner = index[p + 1].find(Group(group.value | bit, group.mask));
+                if (partner < 0) {
+                    continue;
+                }
+                uint64_t shared = outputs & levelOutputs[p + 1][partner];
+                if (shared == 0) {
+                    continue;
+                }
+                merged = merged || shared == outputs;
+                if (kept) {
+                    chunk.merged.push_back(group.extend(bit));
+                    chunk.mergedOutputs.push_back(shared);
+                }
+            }
+            for (uint64_t bits = group.value; bits != 0 && !merged; bits &= bits - 1) {
+                int partner = index[p - 1].find(Group(group.value ^ (bits & (~bits + 1)), group.mask));
+                merged = partner >= 0 && (levelOutputs[p - 1][partner] & outputs) == outputs;
+            }
+            if (!merged && coversTarget(group, outputs, targets)) {
+                chunk.primes.push_back(group);
+                chunk.primeOutputs.push_back(outputs);
+            }
+        }
+    }
+
+    public:
+    //targets[i] and dontCares[i] are the packed tables of output i, at most 64 outputs
+    //Cells set in some output's targets or dontCares start as level 0, only primes covering a target of one of their outputs are kept
+    PrimeGenerator(const vector<vector<uint64_t>> &targets, const vector<vector<uint64_t>> &dontCares, int varCount, WorkPool &pool) {
+        this->varCount = varCount;
+        level.resize(varCount + 1);
+        levelOutputs.resize(varCount + 1);
+        for (uint64_t word = 0; word < targets[0].size(); word++) {
+            uint64_t bits = 0;
+            for (int output = 0; output < targets.size(); output++) {
+                bits |= targets[output][word] | dontCares[output][word];
+            }
+            while (bits != 0) {
+                int offset = popcount64((bits & (~bits + 1)) - 1);
+                uint64_t cell = word * 64 + offset;
+                bits &= bits - 1;
+                uint64_t outputs = 0;
+                for (int output = 0; output < targets.size(); output++) {
+                    outputs |= (((targets[output][word] | dontCares[output][word]) >> offset) & 1) << output;
+                }
+                level[popcount64(cell)].push_back(Group(cell, 0));
+                levelOutputs[popcount64(cell)].push_back(outputs);
+            }
+        }
+        bool empty = false;
+        while (!empty) {
+            int bucketCount = level.size();
+            index.resize(bucketCount);
+            pool.run(bucketCount, [&](int p) {
+                index[p].reset(level[p].size());
+                for (int x = 0; x < level[p].size(); x++) {
+                    index[p].insert(level[p][x], x);
+                }
+            });
+            vector<Chunk> chunks;
+            for (int p = 0; p < bucketCount; p++) {
+                for (int begin = 0; begin < level[p].size(); begin += chunkSize) {
+                    Chunk chunk;
+                    chunk.bucket = p;
+                    chunk.begin = begin;
+                    chunk.end = min<int>(begin + chunkSize, level[p].size());
+                    chunks.push_back(chunk);
+                }
+            }
+            pool.run(chunks.size(), [&](int x) {
+                mergeChunk(chunks[x], targets);
+            });
+            //Chunks are combined in order, giving the same cubes in the same order for any number of threads
+            CubeLevel next(bucketCount);
+            CubeOutputs nextOutputs(bucketCount);
+            empty = true;
+            for (Chunk &chunk : chunks) {
+                next[chunk.bucket].insert(next[chunk.bucket].end(), chunk.merged.begin(), chunk.merged.end());
+                nextOutputs[chunk.bucket].insert(nextOutputs[chunk.bucket].end(), chunk.mergedOutputs.begin(), chunk.mergedOutputs.end());
+                primes.insert(primes.end(), chunk.primes.begin(), chunk.primes.end());
+                primeOutputs.insert(primeOutputs.end(), chunk.primeOutputs.begin(), chunk.primeOutputs.end());
+                empty = empty && chunk.merged.empty();
+            }
+            level.swap(next);
+            levelOutputs.swap(nextOutputs);
+        }
+    }
+    //Primes ordered by size, then by the bucket and order they were formed in
+    vector<Group> &getPrimes() {
+        return primes;
+    }
+    //Outputs each prime is an implicant of, in the order of getPrimes
+    vector<uint64_t> &getPrimeOutputs() {
+        return primeOutputs;
+    }
+};
+
+//Finds every prime implicant of the function whose ON-set is targets
+//pool runs the merging, nullptr meaning the calling thread alone
+vector<Group> primeImplicants(const vector<uint64_t> &targets, const vector<uint64_t> &dontCares, int varCount, WorkPool *pool = nullptr) {
+    WorkPool serial(1);
+    PrimeGenerator generator({targets}, {dontCares}, varCount, pool ? *pool : serial);
+    return generator.getPrimes();
+}
+//Quine-McCluskey prime implicant code above
+
+//Exact minimum cover code below
+//Chooses the fewest groups covering every target cell, posed as a unate covering problem:
+//rows are the target cells, columns are the groups, and a column covers the rows of the cells in its group
+//Essential columns, dominated rows and dominated columns are removed first, then the cyclic core left over is searched by branch and bound
+
+//Limits on the branch and bound search, zero meaning no limit
+//When a limit is hit the best cover found so far is used, which may not be minimal
+struct CoverBudget {
+    uint64_t maxNodes = 0;
+    double maxSeconds = 0;
+};
+
+class CoverSolver {
+    vector<vector<int>> rowColumns;//Columns covering each row, ascending
+    vector<vector<int>> columnRows;//Rows covered by each column, ascending
+    vector<char> rowActive;
+    vector<char> columnActive;
+    vector<int> chosen;//Columns already known to be in the cover
+
+    //Cyclic core, searched with the uncovered core rows packed 64 per word
+    //A node of the search: the core rows still uncovered, the core columns left out and the columns chosen to reach it
+    //Every branch works on its own copy, so the search shares nothing between branches but the best cover and the budget
+    struct CoverNode {
+        vector<uint64_t> uncovered;
+        vector<uint64_t> excluded;
+        vector<int> current;
+    };
+    vector<int> coreColumns;//Column index of each core column
+    //A core column keeps its rows packed the same way, only the words holding some of them,
+    //so covering, counting and comparing columns are ANDs and popcounts over a few words
+    vector<int> rowsStart;//Core column c's rows are the words rowWords[rowsStart[c]] up to rowWords[rowsStart[c + 1]], ascending
+    vector<int> rowWords;
+    vector<uint64_t> rowBits;//Core rows of each word in rowWords
+    vector<vector<int>> coreRowColumns;//Core columns covering each core row
+    vector<int> rowOrder;//Core rows by ascending number of columns, for the lower bound
+    vector<int> columnStamps;
+    int stamp = 0;
+    vector<int> best;
+    CoverBudget budget;
+    WorkPool *pool;//Runs the reductions, nullptr meaning the calling thread alone
+    static const int chunkSize = 1024;
+    uint64_t nodes = 0;
+    chrono::steady_clock::time_point start;
+    bool stopped = false;
+    SolveStats *stats = nullptr;
+
+    static bool isSubset(const vector<int> &small, const vector<int> &large) {
+        for (int item : small) {
+            if (!binary_search(large.begin(), large.end(), item)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    vector<int> activeColumns(int row) {
+        vector<int> columns;
+        for (int column : rowColumns[row]) {
+            if (columnActive[column]) {
+                columns.push_back(column);
+            }
+        }
+        return columns;
+    }
+    vector<int> activeRows(int column) {
+        vector<int> rows;
+        for (int row : columnRows[column]) {
+            if (rowActive[row]) {
+                rows.push_back(row);
+            }
+        }
+        return rows;
+    }
+    void choose(int column) {
+        chosen.push_back(column);
+        columnActive[column] = 0;
+        for (int row : columnRows[column]) {
+            rowActive[row] = 0;
+        }
+    }
+
+    //Calls visit(chunk, begin, end) on the pool for each run of chunkSize indices below count
+    void forChunks(int count, const function<void(int, int, int)> &visit) {
+        WorkPool serial(1);
+        (pool ? *pool : serial).run((count + chunkSize - 1) / chunkSize, [&](int chunk) {
+            visit(chunk, chunk * chunkSize, min(count, (chunk + 1) * chunkSize));
+        });
+    }
+
+    //The reductions below check every row or column against the state before the pass, in parallel,
+    //and then apply what they found, which removes the same rows and columns as checking them one at a time would
+
+    //Chooses every column that is the only one left covering some row
+    bool takeEssentials() {
+        vector<int> only(rowColumns.size(), -1);
+        forChunks(rowColumns.size(), [&](int, int begin, int end) {
+            for (int row = begin; row < end; row++) {
+                if (rowActive[row]) {
+                    vector<int> columns = activeColumns(row);
+                    if (columns.size() == 1) {
+                        only[row] = columns[0];
+                    }
+                }
+            }
+        });
+        bool changed = false;
+        for (int row = 0; row < rowColumns.size(); row++) {
+            if (only[row] >= 0 && columnActive[only[row]]) {
+                choose(only[row]);
+                changed = true;
+            }
+        }
+        return changed;
+    }
+    //Drops rows whose columns include all the columns of another row, since covering that row covers them too
+    //Of rows with the same columns the first is kept
+    bool removeDominatedRows() {
+        vector<vector<int>> dominated((rowColumns.size() + chunkSize - 1) / chunkSize);
+        forChunks(rowColumns.size(), [&](int chunk, int begin, int end) {
+            for (int row = begin; row < end; row++) {
+                if (!rowActive[row]) {
+                    continue;
+                }
+                vector<int> columns = activeColumns(row);
+                if (columns.empty()) {
+                    continue;
+                }
+                for (int other : columnRows[columns[0]]) {
+                    if (other != row && rowActive[other] && isSubset(columns, rowColumns[other])
+                            && (row < other || activeColumns(other).size() > columns.size())) {
+                        dominated[chunk].push_back(other);
+                    }
+                }
+            }
+        });
+        bool changed = false;
+        for (const vector<int> &rows : dominated) {
+            for (int row : rows) {
+                changed = changed || rowActive[row];
+                rowActive[row] = 0;
+            }
+        }
+        return changed;
+    }
+    //Drops columns whose rows are all covered by another single column
+    //Any such column also covers the column's row with the fewest columns, so only those are compared
+    //Of columns with the same rows the last is kept
+    bool removeDominatedColumns() {
+        vector<char> dominated(columnRows.size(), 0);
+        forChunks(columnRows.size(), [&](int, int begin, int end) {
+            for (int column = begin; column < end; column++) {
+                if (!columnActive[column]) {
+                    continue;
+                }
+                vector<int> rows = activeRows(column);
+                if (rows.empty()) {
+                    dominated[column] = 1;
+                    continue;
+                }
+                int rarest = rows[0];
+                for (int row : rows) {
+                    if (rowColumns[row].size() < rowColumns[rarest].size()) {
+                        rarest = row;
+                    }
+                }
+                for (int other : rowColumns[rarest]) {
+                    if (other != column && columnActive[other] && isSubset(rows, columnRows[other])
+                            && (other > column || activeRows(other).size() > rows.size())) {
+                        dominated[column] = 1;
+                        break;
+                    }
+                }
+            }
+        });
+        bool changed = false;
+        for (int column = 0; column < columnRows.size(); column++) {
+            if (dominated[column]) {
+                columnActive[column] = 0;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    void buildCore() {
+        vector<int> coreRow(rowColumns.size(), -1);
+        int rowCount = 0;
+        for (int row = 0; row < rowColumns.size(); row++) {
+            if (rowActive[row]) {
+                coreRow[row] = rowCount++;
+            }
+        }
+        coreRowColumns.assign(rowCount, vector<int>());
+        rowsStart.push_back(0);
+        for (int column = 0; column < columnRows.size(); column++) {
+            if (!columnActive[column]) {
+                continue;
+            }
+            //Core rows are numbered in the order of the rows, so the words come out ascending
+            for (int row : columnRows[column]) {
+                if (rowActive[row]) {
+                    int core = coreRow[row];
+                    if (rowWords.size() == rowsStart.back() || rowWords.back() != core / 64) {
+                        rowWords.push_back(core / 64);
+                        rowBits.push_back(0);
+                    }
+                    rowBits.back() |= 1ull << (core % 64);
+                    coreRowColumns[core].push_back(coreColumns.size());
+                }
+            }
+            coreColumns.push_back(column);
+            rowsStart.push_back(rowWords.size());
+        }
+        rowOrder.resize(rowCount);
+        for (int row = 0; row < rowCount; row++) {
+            rowOrder[row] = row;
+        }
+        stable_sort(rowOrder.begin(), rowOrder.end(), [this](int a, int b) {
+            return coreRowColumns[a].size() < coreRowColumns[b].size();
+        });
+        columnStamps.assign(coreColumns.size(), 0);
+    }
+    static bool isSet(const vector<uint64_t> &bits, int index) {
+        return (bits[index / 64] >> (index % 64)) & 1;
+    }
+    static void setBit(vector<uint64_t> &bits, int index) {
+        bits[index / 64] |= 1ull << (index % 64);
+    }
+    int countCovered(const vector<uint64_t> &uncovered, int column) {
+        int count = 0;
+        for (int x = rowsStart[column]; x < rowsStart[column + 1]; x++) {
+            count += popcount64(uncovered[rowWords[x]] & rowBits[x]);
+        }
+        return count;
+    }
+    void cover(vector<uint64_t> &uncovered, int column) {
+        for (int x = rowsStart[column]; x < rowsStart[column + 1]; x++) {
+            uncovered[rowWords[x]] &= ~rowBits[x];
+        }
+    }
+    //Whether a column covers every row of rows, given as words of packed rows in ascending order
+    bool coversRows(int column, const vector<pair<int, uint64_t>> &rows) {
+        int x = rowsStart[column];
+        int end = rowsStart[column + 1];
+        for (const pair<int, uint64_t> &word : rows) {
+            while (x < end && rowWords[x] < word.first) {
+                x++;
+            }
+            if (x == end || rowWords[x] != word.first || (word.second & ~rowBits[x]) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+    //Rows sharing no available column each need a different column, so a set of them bounds the columns still needed
+    int independentRows(const CoverNode &node) {
+        stamp++;
+        int count = 0;
+        for (int row : rowOrder) {
+            if (!isSet(node.uncovered, row)) {
+                continue;
+            }
+            bool independent = true;
+            for (int column : coreRowColumns[row]) {
+                independent = independent && (isSet(node.excluded, column) || columnStamps[column] != stamp);
+            }
+            if (independent) {
+                for (int column : coreRowColumns[row]) {
+                    columnStamps[column] = stamp;
+                }
+                count++;
+            }
+        }
+        return count;
+    }
+    bool outOfBudget() {
+        nodes++;
+        if (budget.maxNodes != 0 && nodes > budget.maxNodes) {
+            stopped = true;
+        }
+        if (budget.maxSeconds != 0 && chrono::duration<double>(chrono::steady_clock::now() - start).count() > budget.maxSeconds) {
+            stopped = true;
+            timedOut = true;
+        }
+        return stopped;
+    }
+    //Repeatedly takes the column covering the most uncovered rows, giving the first upper bound
+    void greedyCover(vector<uint64_t> uncovered) {
+        best.clear();
+        //Counts only fall, so a column queued with a stale count is queued again until the top count is current
+        //Ties go to the lowest column
+        vector<int> counts(coreColumns.size());
+        priority_queue<pair<int, int>> ranked;
+        for (int column = 0; column < coreColumns.size(); column++) {
+            counts[column] = countCovered(uncovered, column);
+            ranked.push(make_pair(counts[column], -column));
+        }
+        while (!ranked.empty() && ranked.top().first > 0) {
+            int bestColumn = -ranked.top().second;
+            int queuedCount = ranked.top().first;
+            ranked.pop();
+            if (counts[bestColumn] != queuedCount) {
+                ranked.push(make_pair(counts[bestColumn], -bestColumn));
+                continue;
+            }
+            best.push_back(bestColumn);
+            for (int x = rowsStart[bestColumn]; x < rowsStart[bestColumn + 1]; x++) {
+                int word = rowWords[x];
+                for (uint64_t bits = uncovered[word] & rowBits[x]; bits != 0; bits &= bits - 1) {
+                    int row = word * 64 + popcount64((bits & (~bits + 1)) - 1);
+                    for (int column : coreRowColumns[row]) {
+                        counts[column]--;
+                    }
+                }
+                uncovered[word] &= ~rowBits[x];
+            }
+        }
+    }
+    //Chooses the columns that are the only ones left for some row and leaves out columns covering no more than another column
+    //Returns false if some row has no column left
+    bool reduceNode(CoverNode &node) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int word = 0; word < node.uncovered.size(); word++) {
+                for (uint64_t bits = node.uncovered[word]; bits != 0; bits &= bits - 1) {
+                    int row = word * 64 + popcount64((bits & (~bits + 1)) - 1);
+                    if (!isSet(node.uncovered, row)) {
+                        continue;
+                    }
+                    int only = -1;
+                    int count = 0;
+                    for (int column : coreRowColumns[row]) {
+                        if (!isSet(node.excluded, column)) {
+                            only = column;
+                            count++;
+                        }
+                    }
+                    if (count == 0) {
+                        return false;
+                    }
+                    if (count == 1) {
+                        node.current.push_back(only);
+                        cover(node.uncovered, only);
+                        changed = true;
+                    }
+                }
+            }
+            if (changed) {
+                continue;
+            }
+            //A column can only be covered by another column sharing its uncovered row with the fewest columns
+            vector<pair<int, uint64_t>> rows;
+            for (int column = 0; column < coreColumns.size(); column++) {
+                if (isSet(node.excluded, column)) {
+                    continue;
+                }
+                rows.clear();
+                int rarest = -1;
+                for (int x = rowsStart[column]; x < rowsStart[column + 1]; x++) {
+                    int word = rowWords[x];
+                    uint64_t bits = node.uncovered[word] & rowBits[x];
+                    if (bits != 0) {
+                        rows.push_back(make_pair(word, bits));
+                    }
+                    for (; bits != 0; bits &= bits - 1) {
+                        int row = word * 64 + popcount64((bits & (~bits + 1)) - 1);
+                        if (rarest < 0 || coreRowColumns[row].size() < coreRowColumns[rarest].size()) {
+                            rarest = row;
+                        }
+                    }
+                }
+                if (rows.empty()) {
+                    continue;
+                }
+                for (int other : coreRowColumns[rarest]) {
+                    if (other == column || isSet(node.excluded, other)) {
+                        continue;
+                    }
+                    if (coversRows(other, rows)) {
+                        setBit(node.excluded, column);
+                        changed = true;
+                        break;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+    //Reduces the node in place, so callers hand in a copy of their own
+    void search(CoverNode &node) {
+        if (outOfBudget()) {
+            return;
+        }
+        if (reduceNode(node) && node.current.size() < best.size()) {
+            branch(node);
+        }
+    }
+    void branch(CoverNode &node) {
+        int bound = node.current.size() + independentRows(node);
+        if (bound >= best.size()) {
+            return;
+        }
+        //When one more column would reach the best cover, a column meeting none of the independent rows leaves the bound
+        //where it was and so cannot lead to a better cover, and is left out
+        if (bound + 1 == best.size()) {
+            for (int column = 0; column < coreColumns.size(); column++) {
+                if (columnStamps[column] != stamp) {
+                    setBit(node.excluded, column);
+                }
+            }
+        }
+        //Branch on the uncovered row with the fewest available columns, since one of them must be chosen
+        int branchRow = -1;
+        int branchCount = 0;
+        for (int word = 0; word < node.uncovered.size(); word++) {
+            for (uint64_t bits = node.uncovered[word]; bits != 0; bits &= bits - 1) {
+                int row = word * 64 + popcount64((bits & (~bits + 1)) - 1);
+                int count = 0;
+                for (int column : coreRowColumns[row]) {
+                    count += !isSet(node.excluded, column);
+                }
+                if (branchRow < 0 || count < branchCount) {
+                    branchRow = row;
+                    branchCount = count;
+                }
+            }
+        }
+        if (branchRow < 0) {
+            best = node.current;
+        }
+        else if (branchCount > 0) {
+            branchOn(branchRow, node);
+        }
+    }
+    void branchOn(int branchRow, CoverNode &node) {
+        vector<pair<int, int>> options;
+        for (int column : coreRowColumns[branchRow]) {
+            if (!isSet(node.excluded, column)) {
+                options.push_back(make_pair(-countCovered(node.uncovered, column), column));
+            }
+        }
+        sort(options.begin(), options.end());
+        //Once the branches choosing a column are done, the later branches leave it out so no cover is searched twice
+        for (const pair<int, int> &option : options) {
+            CoverNode next = node;
+            cover(next.uncovered, option.second);
+            next.current.push_back(option.second);
+            search(next);
+            setBit(node.excluded, option.second);
+            if (stopped) {
+                break;
+            }
+        }
+    }
+
+    public:
+    bool exact = true;//False if the budget ran out before the search finished
+    bool timedOut = false;//Whether it ran out at budget.maxSeconds, leaving a result that depends on how fast the search ran
+
+    CoverSolver(const vector<Group> &groups, const vector<uint64_t> &targets, uint64_t cellCount, CoverBudget budget, WorkPool *pool = nullptr)
+        : CoverSolver(groups, vector<uint64_t>(groups.size(), 1), {targets}, cellCount, budget, pool) {}
+    //Covers several outputs at once, with a row for each target cell of each output
+    //A group covers the rows of its cells for the outputs set in its mask in groupOutputs
+    CoverSolver(const vector<Group> &groups, const vector<uint64_t> &groupOutputs, const vector<vector<uint64_t>> &targets, uint64_t cellCount, CoverBudget budget, WorkPool *pool = nullptr) {
+        this->budget = budget;
+        this->pool = pool;
+        //Target cells are numbered in order, output by output, so the row of a cell is the count of target cells before it
+        //Counts are kept per word rather than per cell, so the table is a fraction of the size of the targets themselves
+        uint64_t wordCount = (cellCount + 63) / 64;
+        vector<vector<int>> rowsBefore(targets.size(), vector<int>(wordCount));
+        int rowCount = 0;
+        for (int output = 0; output < targets.size(); output++) {
+            for (uint64_t word = 0; word < wordCount; word++) {
+                rowsBefore[output][word] = rowCount;
+                rowCount += popcount64(targets[output][word]);
+            }
+        }
+        rowColumns.assign(rowCount, vector<int>());
+        columnRows.assign(groups.size(), vector<int>());
+        for (int column = 0; column < groups.size(); column++) {
+            for (int output = 0; output < targets.size(); output++) {
+                if (((groupOutputs[column] >> output) & 1) == 0) {
+                    continue;
+                }
+                const vector<uint64_t> &outputTargets = targets[output];
+                groups[column].forEachWord([&](uint64_t word, uint64_t bits) {
+                    uint64_t covered = outputTargets[word] & bits;
+                    while (covered != 0) {
+                        uint64_t low = covered & (~covered + 1);
+                        int row = rowsBefore[output][word] + popcount64(outputTargets[word] & (low - 1));
+                        columnRows[column].push_back(row);
+                        rowColumns[row].push_back(column);
+                        covered ^= low;
+                    }
+                });
+            }
+            sort(columnRows[column].begin(), columnRows[column].end());
+        }
+        rowActive.assign(rowCount, 1);
+        columnActive.assign(groups.size(), 1);
+    }
+
+    //Indices of the chosen groups, in ascending order
+    void setStats(SolveStats *stats) {
+        this->stats = stats;
+    }
+    vector<int> solve() {
+        start = chrono::steady_clock::now();
+        {
+            STATS_PHASE(stats, "cover_reduce");
+            bool changed = true;
+            while (changed) {
+                changed = takeEssentials();
+                changed = removeDominatedRows() || changed;
+                changed = removeDominatedColumns() || changed;
+            }
+            buildCore();
+        }
+        STATS_COUNT(stats, "essential_groups", chosen.size());
+        STATS_COUNT(stats, "core_rows", coreRowColumns.size());
+        STATS_COUNT(stats, "core_columns", coreColumns.size());
+        if (!coreColumns.empty()) {
+            STATS_PHASE(stats, "cover_search");
+            CoverNode root;
+            root.uncovered.assign((coreRowColumns.size() + 63) / 64, 0);
+            for (int row = 0; row < coreRowColumns.size(); row++) {
+                setBit(root.uncovered, row);
+            }
+            root.excluded.assign((coreColumns.size() + 63) / 64, 0);
+            greedyCover(root.uncovered);
+            search(root);
+            exact = !stopped;
+            for (int column : best) {
+                chosen.push_back(coreColumns[column]);
+            }
+        }
+        STATS_COUNT(stats, "cover_nodes", nodes);
+        STATS_COUNT(stats, "cover_stopped", stopped ? 1 : 0);
+        sort(chosen.begin(), chosen.end());
+        return chosen;
+    }
+};
+
+//Keeps the fewest groups that still cover every target cell
+//timedOut, if given, is set to whether the search was cut short by budget.maxSeconds
+vector<Group> minimumCover(const vector<Group> &groups, const vector<uint64_t> &targets, uint64_t cellCount, CoverBudget budget = CoverBudget(), WorkPool *pool = nullptr, SolveStats *stats = nullptr, bool *timedOut = nullptr) {
+    vector<Group> result;
+    CoverSolver solver(groups, targets, cellCount, budget, pool);
+    solver.setStats(stats);
+    for (int column : solver.solve()) {
+        result.push_back(groups[column]);
+    }
+    if (timedOut != nullptr) {
+        *timedOut = solver.timedOut;
+    }
+    return result;
+}
+//Exact minimum cover code above
+
+//Multiple output code below
+//Functions of the same inputs are minimized together so that a product needed by several of them is only counted once
+//The primes are cubes with the outputs they are implicants of, found by one pass of the Quine-McCluskey merging
+//The fewest primes covering every output's targets are chosen, then each output keeps the fewest of those that cover it
+
+//targets[i] and dontCares[i] are the packed tables of output i, at most 64 outputs
+//Returns the groups covering each output, a product shared by several outputs is the same group in each of their covers
+//pool runs the merging and the cover reductions, nullptr meaning the calling thread alone
+vector<vector<Group>> multipleOutputCover(const vector<vector<uint64_t>> &targets, const vector<vector<uint64_t>> &dontCares, int varCount, CoverBudget budget = CoverBudget(), WorkPool *pool = nullptr) {
+    uint64_t cellCount = 1ull << varCount;
+    WorkPool serial(1);
+    PrimeGenerator generator(targets, dontCares, varCount, pool ? *pool : serial);
+    const vector<Group> &primes = generator.getPrimes();
+    const vector<uint64_t> &primeOutputs = generator.getPrimeOutputs();
+    vector<Group> shared;
+    vector<uint64_t> sharedOutputs;
+    for (int column : CoverSolver(primes, primeOutputs, targets, cellCount, budget, pool).solve()) {
+        shared.push_back(primes[column]);
+        sharedOutputs.push_back(primeOutputs[column]);
+    }
+    //A prime is an implicant of every output in its mask, but may not be needed by all of them
+    vector<vector<Group>> covers;
+    for (int output = 0; output < targets.size(); output++) {
+        vector<Group> candidates;
+        for (int x = 0; x < shared.size(); x++) {
+            if ((sharedOutputs[x] >> output) & 1) {
+                candidates.push_back(shared[x]);
+            }
+        }
+        covers.push_back(minimumCover(candidates, targets[output], cellCount, budget, pool));
+    }
+    return covers;
+}
+//Multiple output code above
+
+//Espresso heuristic minimizer code below
+//Works on covers, lists of cubes whose union is a function, so functions of up to 64 variables never need a truth table
+//The cover is expanded, made irredundant and reduced, over and over until it stops shrinking
+//Every step is answered by tautology checks on cofactors of the covers, so the OFF-set, which may be huge, is never built
+//The result is a small cover of prime implicants, but unlike QUINE_MCCLUSKEY it is not guaranteed to be the smallest
+typedef vector<Group> Cover;
+
+//Mask of the bits used by varCount variables
+uint64_t variableBits(int varCount) {
+    return varCount == 64 ? ~0ull : (1ull << varCount) - 1;
+}
+
+bool intersects(const Group &a, const Group &b) {
+    return ((a.value ^ b.value) & ~a.mask & ~b.mask) == 0;
+}
+
+//Checks whether every cell of inner is in outer
+bool contains(const Group &outer, const Group &inner) {
+    return (inner.mask & ~outer.mask) == 0 && ((outer.value ^ inner.value) & ~outer.mask) == 0;
+}
+
+//Adds cubes covering the cells set in bits between first and first + 2^freeBits
+//Ranges that are all set become one cube, mixed ranges are split in half on their most significant free variable
+void addRangeCubes(const vector<uint64_t> &bits, uint64_t first, int freeBits, Cover &cover) {
+    uint64_t count = 1ull << freeBits;
+    bool any = false;
+    bool all = true;
+    if (count >= 64) {
+        for (uint64_t word = first / 64; word < (first + count) / 64; word++) {
+            any = any || bits[word] != 0;
+            all = all && bits[word] == ~0ull;
+        }
+    }
+    else {
+        uint64_t range = (bits[first / 64] >> (first % 64)) & ((1ull << count) - 1);
+        any = range != 0;
+        all = range == (1ull << count) - 1;
+    }
+    if (all) {
+        cover.push_back(Group(first, count - 1));
+    }
+    else if (any) {
+        addRangeCubes(bits, first, freeBits - 1, cover);
+        addRangeCubes(bits, first + count / 2, freeBits - 1, cover);
+    }
+}
+
+//Disjoint cover of the cells set in a packed table
+Cover tableCover(const vector<uint64_t> &bits, int varCount) {
+    Cover cover;
+    addRangeCubes(bits, 0, varCount, cover);
+    return cover;
+}
+
+//Packed table of the cells in a cover, the reverse of tableCover
+vector<uint64_t> coverTable(const Cover &cover, int varCount) {
+    vector<uint64_t> bits(((1ull << varCount) + 63) / 64);
+    for (const Group &cube : cover) {
+        cube.forEachWord([&](uint64_t word, uint64_t pattern) {bits[word] |= pattern;});
+    }
+    return bits;
+}
+
+//Number of cubes covering each cell, stored bit sliced: plane k holds bit k of every cell's count, 64 cells per word
+//Adding or removing a cube ripples a carry through the planes over the words the cube meets,
+//and the cells covered at all and covered more than once are kept beside the planes,
+//so the cells only one cube covers are found with an AND a word rather than a count a cell
+class CoverCounts {
+    vector<vector<uint64_t>> planes;
+    vector<uint64_t> any;//Cells covered at least once
+    vector<uint64_t> many;//Cells covered at least twice
+    vector<uint64_t> within;//Cells counted
+
+    public:
+    CoverCounts() {}
+    //Counts only the cells set in within
+    CoverCounts(const vector<uint64_t> &within) {
+        this->within = within;
+        any.assign(within.size(), 0);
+        many = any;
+    }
+    void add(const Group &cube) {
+        cube.forEachWord([this](uint64_t word, uint64_t bits) {
+            uint64_t carry = bits & within[word];
+            many[word] |= any[word] & carry;
+            any[word] |= carry;
+            for (int plane = 0; carry != 0; plane++) {
+                if (plane == planes.size()) {
+                    planes.push_back(vector<uint64_t>(any.size(), 0));
+                }
+                uint64_t next = planes[plane][word] & carry;
+                planes[plane][word] ^= carry;
+                carry = next;
+            }
+        });
+    }
+    void remove(const Group &cube) {
+        cube.forEachWord([this](uint64_t word, uint64_t bits) {
+            uint64_t borrow = bits & within[word];
+            if (borrow == 0) {
+                return;
+            }
+            for (int plane = 0; borrow != 0; plane++) {
+                uint64_t next = ~planes[plane][word] & borrow;
+                planes[plane][word] ^= borrow;
+                borrow = next;
+            }
+            uint64_t more = 0;
+            for (int plane = 1; plane < planes.size(); plane++) {
+                more |= planes[plane][word];
+            }
+            many[word] = more;
+            any[word] = more | planes[0][word];
+        });
+    }
+    //Cells of a word covered exactly once
+    uint64_t once(uint64_t word) const {
+        return any[word] & ~many[word];
+    }
+    //Whether some cell of a cube is covered by it alone
+    bool coversOnce(const Group &cube) const {
+        bool found = false;
+        cube.forEachWord([&](uint64_t word, uint64_t bits) {found = found || (once(word) & bits) != 0;});
+        return found;
+    }
+};
+
+class Espresso {
+    uint64_t varBits;
+    Cover onSet;
+    Cover dcSet;
+    Cover careSet;//ON-set and DC-set together, which every cube of the cover must stay inside
+    vector<uint64_t> careTable;//The care set packed 64 cells per word, if the function came from a truth table
+    vector<uint64_t> onTable;//The ON-set packed 64 cells per word, if the function came from a truth table
+    CoverCounts coverCounts;//Number of cubes covering each ON cell, zero for every other cell
+
+    //Cubes of a cover that meet the half of the space where the variable at bit equals value, with that variable freed
+    Cover cofactor(const Cover &cover, uint64_t bit, bool value) {
+        Cover result;
+        for (const Group &cube : cover) {
+            if ((cube.mask & bit) || ((cube.value & bit) != 0) == value) {
+                result.push_back(Group(cube.value & ~bit, cube.mask | bit));
+            }
+        }
+        return result;
+    }
+    //Cubes of a cover that meet a cube, with the cube's fixed variables freed
+    Cover cofactor(const Cover &cover, const Group &cube) {
+        Cover result;
+        uint64_t fixed = ~cube.mask & varBits;
+        for (const Group &other : cover) {
+            if (intersects(other, cube)) {
+                result.push_back(Group(other.value & ~fixed, other.mask | fixed));
+            }
+        }
+        return result;
+    }
+    //Cofactor of the DC-set and the kept cubes of a cover other than cover[skip], against cover[skip]
+    Cover cofactorOthers(const Cover &cover, const vector<char> &kept, int skip) {
+        Cover result = cofactor(dcSet, cover[skip]);
+        uint64_t fixed = ~cover[skip].mask & varBits;
+        for (int x = 0; x < cover.size(); x++) {
+            if (x != skip && kept[x] && intersects(cover[x], cover[skip])) {
+                result.push_back(Group(cover[x].value & ~fixed, cover[x].mask | fixed));
+            }
+        }
+        return result;
+    }
+    //Variable fixed in the most cubes among the candidate bits
+    uint64_t mostUsed(const Cover &cover, uint64_t candidates) {
+        uint64_t best = candidates & (~candidates + 1);
+        int bestCount = -1;
+        for (uint64_t bits = candidates; bits != 0; bits &= bits - 1) {
+            uint64_t bit = bits & (~bits + 1);
+            int count = 0;
+            for (const Group &cube : cover) {
+                count += (cube.mask & bit) == 0;
+            }
+            if (count > bestCount) {
+                best = bit;
+                bestCount = count;
+            }
+        }
+        return best;
+    }
+    //Finds the variables that appear as a plain and as a negated literal, or returns false if the cover holds the universal cube
+    bool literalUse(const Cover &cover, uint64_t &plain, uint64_t &negated) {
+        plain = 0;
+        negated = 0;
+        for (const Group &cube : cover) {
+            uint64_t fixed = ~cube.mask & varBits;
+            if (fixed == 0) {
+                return false;
+            }
+            plain |= cube.value & fixed;
+            negated |= ~cube.value & fixed;
+        }
+        return true;
+    }
+    //Checks whether a cover contains every cell
+    bool tautology(const Cover &cover) {
+        uint64_t plain;
+        uint64_t negated;
+        if (cover.empty()) {
+            return false;
+        }
+        if (!literalUse(cover, plain, negated)) {
+            return true;
+        }
+        //A cover in which no variable appears both ways is only a tautology if it holds the universal cube
+        if ((plain & negated) == 0) {
+            return false;
+        }
+        uint64_t bit = mostUsed(cover, plain & negated);
+        return tautology(cofactor(cover, bit, 0)) && tautology(cofactor(cover, bit, 1));
+    }
+    //Smallest cube containing every cell not in a cover, which is all reduce needs, without building the complement itself
+    //Returns false if the cover contains every cell
+    bool complementSupercube(const Cover &cover, Group &super) {
+        uint64_t plain;
+        uint64_t negated;
+        if (cover.empty()) {
+            super = Group(0, varBits);
+            return true;
+        }
+        if (!literalUse(cover, plain, negated)) {
+            return false;
+        }
+        if (cover.size() == 1) {
+            //By De Morgan the complement of a cube is the union of its negated literals, which only leaves a literal fixed if there is one
+            uint64_t fixed = ~cover[0].mask & varBits;
+            super = popcount64(fixed) == 1 ? Group(~cover[0].value & fixed, varBits & ~fixed) : Group(0, varBits);
+            return true;
+        }
+        uint64_t bit = mostUsed(cover, (plain & negated) ? plain & negated : plain | negated);
+        Group low(0, 0);
+        Group high(0, 0);
+        bool hasLow = complementSupercube(cofactor(cover, bit, 0), low);
+        bool hasHigh = complementSupercube(cofactor(cover, bit, 1), high);
+        low = Group(low.value & ~bit, low.mask & ~bit);
+        high = Group(high.value | bit, high.mask & ~bit);
+        if (!hasLow || !hasHigh) {
+            super = hasLow ? low : high;
+            return hasLow || hasHigh;
+        }
+        uint64_t mask = low.mask | high.mask | (low.value ^ high.value);
+        super = Group(low.value & ~mask, mask);
+        return true;
+    }
+    //Checks whether every cell of a cube is in the ON-set or DC-set
+    //Small cubes of a function with a truth table are checked cell by cell, which beats scanning the care set
+    bool inCareSet(const Group &cube) {
+        if (!careTable.empty() && cube.size() <= 64) {
+            bool inside = true;
+            cube.forEach([&](uint64_t cell) {
+                inside = inside && ((careTable[cell / 64] >> (cell % 64)) & 1);
+            });
+            return inside;
+        }
+        return tautology(cofactor(careSet, cube));
+    }
+
+    //Grows every cube as far as the care set allows, dropping cubes swallowed by a grown cube
+    //Larger cubes go first, and variables freed in many cubes are raised first, so grown cubes tend to swallow more
+    Cover expand(Cover cover) {
+        stable_sort(cover.begin(), cover.end(), [](const Group &a, const Group &b) {
+            return a.size() > b.size();
+        });
+        vector<pair<int, uint64_t>> order;
+        for (uint64_t bits = varBits; bits != 0; bits &= bits - 1) {
+            uint64_t bit = bits & (~bits + 1);
+            int freeCount = 0;
+            for (const Group &cube : cover) {
+                freeCount += (cube.mask & bit) != 0;
+            }
+            order.push_back(make_pair(-freeCount, bit));
+        }
+        stable_sort(order.begin(), order.end(), [](const pair<int, uint64_t> &a, const pair<int, uint64_t> &b) {
+            return a.first < b.first;
+        });
+        Cover result;
+        vector<char> covered(cover.size(), 0);
+        for (int x = 0; x < cover.size(); x++) {
+            if (covered[x]) {
+                continue;
+            }
+            Group cube = cover[x];
+            for (const pair<int, uint64_t> &literal : order) {
+                if (!(cube.mask & literal.second) && inCareSet(cube.extend(literal.second))) {
+                    cube = cube.extend(literal.second);
+                }
+            }
+            for (int y = x + 1; y < cover.size(); y++) {
+                covered[y] = covered[y] || contains(cube, cover[y]);
+            }
+            result.push_back(cube);
+        }
+        return result;
+    }
+    //Drops cubes whose cells are all covered by the rest of the cover and the DC-set, smallest first
+    Cover irredundant(const Cover &cover) {
+        vector<int> order(cover.size());
+        for (int x = 0; x < order.size(); x++) {
+            order[x] = x;
+        }
+        stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return cover[a].size() < cover[b].size();
+        });
+        vector<char> kept(cover.size(), 1);
+        if (!onTable.empty()) {
+            //With a truth table a cube is redundant when every ON cell in it is covered by another cube
+            countCover(cover);
+            for (int x : order) {
+                if (!coverCounts.coversOnce(cover[x])) {
+                    kept[x] = 0;
+                    uncount(cover[x]);
+                }
+            }
+        }
+        else {
+            for (int x : order) {
+                kept[x] = !tautology(cofactorOthers(cover, kept, x));
+            }
+        }
+        Cover result;
+        for (int x = 0; x < cover.size(); x++) {
+            if (kept[x]) {
+                result.push_back(cover[x]);
+            }
+        }
+        return result;
+    }
+    //Shrinks every cube to the smallest cube holding the cells only it covers, so the next expand can grow it another way
+    Cover reduce(Cover cover) {
+        stable_sort(cover.begin(), cover.end(), [](const Group &a, const Group &b) {
+            return a.size() > b.size();
+        });
+        vector<char> kept(cover.size(), 1);
+        if (!onTable.empty()) {
+            //With a truth table the cells only a cube covers are its ON cells counted once
+            countCover(cover);
+        }
+        for (int x = 0; x < cover.size(); x++) {
+            Group super(0, 0);
+            if (!onTable.empty()) {
+                kept[x] = countedOnce(cover[x], super);
+                uncount(cover[x]);
+                if (kept[x]) {
+                    cover[x] = super;
+                    recount(super);
+                }
+                continue;
+            }
+            if (!complementSupercube(cofactorOthers(cover, kept, x), super)) {
+                kept[x] = 0;
+                continue;
+            }
+            //The cofactor leaves the cube's own variables free, so the supercube only narrows the free ones
+            cover[x] = Group(cover[x].value | (super.value & cover[x].mask), cover[x].mask & super.mask);
+        }
+        Cover result;
+        for (int x = 0; x < cover.size(); x++) {
+            if (kept[x]) {
+                result.push_back(cover[x]);
+            }
+        }
+        return result;
+    }
+    //Counts the cubes of a cover holding each ON cell of a truth table
+    void countCover(const Cover &cover) {
+        coverCounts = CoverCounts(onTable);
+        for (const Group &cube : cover) {
+            recount(cube);
+        }
+    }
+    void recount(const Group &cube) {
+        coverCounts.add(cube);
+    }
+    void uncount(const Group &cube) {
+        coverCounts.remove(cube);
+    }
+    //Finds the smallest cube holding the ON cells of a cube that no other cube covers, or returns false if there are none
+    bool countedOnce(const Group &cube, Group &super) {
+        bool found = false;
+        cube.forEachWord([&](uint64_t word, uint64_t bits) {
+            for (uint64_t once = coverCounts.once(word) & bits; once != 0; once &= once - 1) {
+                uint64_t cell = word * 64 + popcount64((once & (~once + 1)) - 1);
+                uint64_t mask = found ? super.mask | (super.value ^ cell) : 0;
+                super = Group(cell & ~mask, mask);
+                found = true;
+            }
+        });
+        return found;
+    }
+    //Covers are compared by number of cubes, then by number of literals
+    pair<uint64_t, uint64_t> cost(const Cover &cover) {
+        uint64_t literals = 0;
+        for (const Group &cube : cover) {
+            literals += popcount64(~cube.mask & varBits);
+        }
+        return make_pair((uint64_t) cover.size(), literals);
+    }
+
+    public:
+    Espresso(const Cover &onSet, const Cover &dcSet, int varCount) {
+        this->varBits = variableBits(varCount);
+        this->onSet = onSet;
+        this->dcSet = dcSet;
+        careSet = onSet;
+        careSet.insert(careSet.end(), dcSet.begin(), dcSet.end());
+    }
+    //Minimizes the function of a truth table, given its ON-set and DC-set packed 64 cells per word
+    Espresso(const vector<uint64_t> &onTable, const vector<uint64_t> &dcTable, int varCount) : Espresso(tableCover(onTable, varCount), tableCover(dcTable, varCount), varCount) {
+        this->onTable = onTable;
+        careTable.resize(onTable.size());
+        for (uint64_t x = 0; x < careTable.size(); x++) {
+            careTable[x] = onTable[x] | dcTable[x];
+        }
+    }
+    Cover minimize() {
+        Cover cover = irredundant(expand(onSet));
+        while (!cover.empty()) {
+            Cover next = irredundant(expand(reduce(cover)));
+            if (!(cost(next) < cost(cover))) {
+                break;
+            }
+            cover.swap(next);
+        }
+        return cover;
+    }
+};
+
+//Minimizes the function covered by onSet, with dcSet left free, without building its truth table
+Cover espresso(const Cover &onSet, const Cover &dcSet, int varCount) {
+    return Espresso(onSet, dcSet, varCount).minimize();
+}
+//Espresso heuristic minimizer code above
+
+//Incremental repair code below
+//When a few cells of a minimized function change, its cover is repaired rather than the function minimized again
+//Cubes still inside the care set are kept and those next to a changed cell grow as far as the new care set allows,
+//cubes reaching a cell that left the care set are dropped, and only the target cells this leaves uncovered grow into new primes,
+//of which the fewest covering them are chosen, before the cubes near the change that became redundant are dropped
+//Each step keeps every cube inside the care set and every target cell covered, so the result is always a valid cover,
+//though it is only as small as the old cover around the changed cells allows
+
+//Cubes of cells added to and removed from the ON-set and DC-set of a function
+//Removals apply before additions, and a cell ending up in both sets is a don't care
+struct TableDelta {
+    Cover addOn;
+    Cover removeOn;
+    Cover addDontCare;
+    Cover removeDontCare;
+};
+
+//Whether every cell of a cube is set in a packed table
+bool tableContains(const vector<uint64_t> &table, const Group &cube) {
+    bool inside = true;
+    cube.forEachWord([&](uint64_t word, uint64_t bits) {inside = inside && (table[word] & bits) == bits;});
+    return inside;
+}
+//Number of cells of a cube set in a packed table
+uint64_t tableCount(const vector<uint64_t> &table, const Group &cube) {
+    uint64_t count = 0;
+    cube.forEachWord([&](uint64_t word, uint64_t bits) {count += popcount64(table[word] & bits);});
+    return count;
+}
+
+//Raises one variable of a cube at a time while it stays inside care, choosing the variable whose raising reaches the most uncovered cells
+Group growCube(Group cube, const vector<uint64_t> &care, const vector<uint64_t> &uncovered, int varCount) {
+    while (true) {
+        uint64_t bestBit = 0;
+        uint64_t bestCount = 0;
+        for (int y = 0; y < varCount; y++) {
+            uint64_t bit = 1ull << y;
+            //Raising a variable adds the cube's mirror image across it
+            Group mirror(cube.value ^ bit, cube.mask);
+            if ((cube.mask & bit) || !tableContains(care, mirror)) {
+                continue;
+            }
+            uint64_t count = tableCount(uncovered, mirror);
+            if (bestBit == 0 || count > bestCount) {
+                bestBit = bit;
+                bestCount = count;
+            }
+        }
+        if (bestBit == 0) {
+            return cube;
+        }
+        cube = cube.extend(bestBit);
+    }
+}
+
+//Repairs a cover of targets, with dontCares left free, after the cells set in changed took new values
+//targets and dontCares are the new tables, and pool runs the cover of the uncovered cells, nullptr meaning the calling thread alone
+vector<Group> repairCover(const vector<Group> &cover, const vector<uint64_t> &targets, const vector<uint64_t> &dontCares, const vector<uint64_t> &changed, int varCount, CoverBudget budget = CoverBudget(), WorkPool *pool = nullptr) {
+    vector<uint64_t> care(targets.size());
+    for (uint64_t x = 0; x < care.size(); x++) {
+        care[x] = targets[x] | dontCares[x];
+    }
+    //A cube is near the change if a changed cell is in it or in its mirror image across one of its variables
+    auto nearChange = [&](const Group &cube) {
+        bool near = tableCount(changed, cube) != 0;
+        for (int y = 0; y < varCount && !near; y++) {
+            uint64_t bit = 1ull << y;
+            near = !(cube.mask & bit) && tableCount(changed, Group(cube.value ^ bit, cube.mask)) != 0;
+        }
+        return near;
+    };
+    Cover kept;
+    vector<char> near;
+    for (const Group &cube : cover) {
+        if (tableContains(care, cube)) {
+            kept.push_back(cube);
+            near.push_back(nearChange(cube));
+        }
+    }
+    vector<uint64_t> uncovered = coverTable(kept, varCount);
+    for (uint64_t x = 0; x < uncovered.size(); x++) {
+        uncovered[x] = targets[x] & ~uncovered[x];
+    }
+    for (int x = 0; x < kept.size(); x++) {
+        if (near[x]) {
+            kept[x] = growCube(kept[x], care, uncovered, varCount);
+            kept[x].forEachWord([&](uint64_t word, uint64_t bits) {uncovered[word] &= ~bits;});
+        }
+    }
+    //Each uncovered cell not reached by an earlier new prime grows into one
+    Cover candidates;
+    vector<uint64_t> reached(uncovered.size(), 0);
+    for (uint64_t word = 0; word < uncovered.size(); word++) {
+        while ((uncovered[word] & ~reached[word]) != 0) {
+            uint64_t bits = uncovered[word] & ~reached[word];
+            uint64_t cell = word * 64 + popcount64((bits & (~bits + 1)) - 1);
+            Group prime = growCube(Group(cell, 0), care, uncovered, varCount);
+            prime.forEachWord([&](uint64_t word, uint64_t bits) {reached[word] |= bits;});
+            candidates.push_back(prime);
+        }
+    }
+    Cover result = kept;
+    vector<char> affected = near;
+    if (!candidates.empty()) {
+        for (const Group &prime : minimumCover(candidates, uncovered, 1ull << varCount, budget, pool)) {
+            result.push_back(prime);
+            affected.push_back(1);
+        }
+    }
+    //Cubes near the change, smallest first, are dropped while every target cell in them is covered by another cube
+    CoverCounts counts(targets);
+    for (const Group &cube : result) {
+        counts.add(cube);
+    }
+    vector<int> order;
+    for (int x = 0; x < result.size(); x++) {
+        if (affected[x]) {
+            order.push_back(x);
+        }
+    }
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return result[a].size() < result[b].size();
+    });
+    vector<char> dropped(result.size(), 0);
+    for (int x : order) {
+        if (!counts.coversOnce(result[x])) {
+            counts.remove(result[x]);
+            dropped[x] = 1;
+        }
+    }
+    Cover repaired;
+    for (int x = 0; x < result.size(); x++) {
+        if (!dropped[x]) {
+            repaired.push_back(result[x]);
+        }
+    }
+    return repaired;
+}
+//Incremental repair code above
+
+//Result cache code below
+//Minimized functions are kept on disk, so a later run or another process skips minimizing a function it has seen
+//A cache is a directory of two files: "log", an append-only list of records each holding a key and the groups chosen for it,
+//and "index", a table of fixed slots memory-mapped by every process, holding the hash, log position and last use of each record
+//Every lookup and insert holds a lock on the index, so any number of processes may share a cache
+//When the log would pass its size limit it is rewritten with the most recently used records that fit in half the limit
+//Words are stored in the machine's own byte order, which the index header records so a cache from another kind of machine starts over
+//Covers whose search was cut short by --max-seconds are not stored, since a later run could do better with the same key
+//On systems without mmap and flock the cache never opens and every lookup misses
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HAS_RESULT_CACHE_FILES
+#endif
+
+//Identifies a minimization: the packed planes of each function and the settings that pick its groups
+struct FunctionKey {
+    int varCount;
+    int solver;//Solver used, or -1 for functions simplified together
+    CoverBudget budget;
+    vector<uint64_t> planes;//ON plane then DC plane of each function
+    uint64_t hash = 0;
+    FunctionKey(int varCount, int solver, CoverBudget budget) {
+        this->varCount = varCount;
+        this->solver = solver;
+        this->budget = budget;
+    }
+    void addFunction(const vector<uint64_t> &on, const vector<uint64_t> &dontCare) {
+        planes.insert(planes.end(), on.begin(), on.end());
+        planes.insert(planes.end(), dontCare.begin(), dontCare.end());
+    }
+    //Hashes the key once all of its functions are added, giving the same hash in every run
+    void finish() {
+        uint64_t mixed = ((uint64_t) varCount << 32) ^ (uint32_t) solver ^ (budget.maxNodes * 0x9E3779B97F4A7C15ull);
+        for (uint64_t word : planes) {
+            mixed = (mixed ^ word) * 0xBF58476D1CE4E5B9ull;
+            mixed ^= mixed >> 31;
+        }
+        hash = mixed;
+    }
+    bool operator==(const FunctionKey &other) const {
+        return hash == other.hash && varCount == other.varCount && solver == other.solver && budget.maxNodes == other.budget.maxNodes
+            && budget.maxSeconds == other.budget.maxSeconds && planes == other.planes;
+    }
+    //The key as stored in a record
+    string bytes() const {
+        string result;
+        appendWord(result, varCount);
+        appendWord(result, (uint32_t) solver);
+        appendWord(result, budget.maxNodes);
+        uint64_t seconds;
+        memcpy(&seconds, &budget.maxSeconds, sizeof(seconds));
+        appendWord(result, seconds);
+        for (uint64_t word : planes) {
+            appendWord(result, word);
+        }
+        return result;
+    }
+    static void appendWord(string &bytes, uint64_t word) {
+        bytes.append((const char *) &word, sizeof(word));
+    }
+};
+
+struct FunctionKeyHash {
+    size_t operator()(const FunctionKey &key) const {
+        return key.hash;
+    }
+};
+
+#ifdef HAS_RESULT_CACHE_FILES
+class ResultCache {
+    struct Header {
+        uint64_t magic;
+        uint64_t byteOrder;//The byteOrder constant as the writing machine stores it, so a machine of the other byte order reads another value
+        uint64_t version;
+        uint64_t slotCount;
+        uint64_t generation;//Counts rewrites of the log, telling other processes to reopen it
+        uint64_t logBytes;//Bytes of the log holding whole records, anything after them is an unfinished write
+        uint64_t entryCount;
+        uint64_t clock;//Counts lookups, stamping each slot with the time of its last use
+    };
+    struct Slot {
+        uint64_t hash;//Hash of the key, 0 for an empty slot
+        uint64_t offset;//Position of the record in the log
+        uint64_t length;//Bytes of the record
+        uint64_t lastUse;
+    };
+    static const uint64_t magic = 0x314548434150414Bull;
+    static const uint64_t byteOrder = 0x0102030405060708ull;
+    static const uint64_t version = 2;//Raised whenever the layout of the index or of a record changes
+    static const uint64_t slotCount = 1 << 16;//Slots are never more than half full, since probing slows down past that
+
+    string directory;
+    uint64_t maxBytes;
+    int indexFile = -1;
+    int logFile = -1;
+    uint64_t generation = 0;//Generation of the log this process has open
+    Header *header = nullptr;
+    Slot *slots = nullptr;
+    size_t mappedBytes = 0;
+    mutex lock;//Threads of this process share one open index, which the file lock alone would not keep apart
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    //Holds both the thread and the process lock for as long as it lives
+    class Guard {
+        ResultCache &cache;
+        unique_lock<mutex> threadLock;
+        public:
+        Guard(ResultCache &cache) : cache(cache), threadLock(cache.lock) {
+            flock(cache.indexFile, LOCK_EX);
+            //Another process may have rewritten the log since this one last looked
+            if (cache.header->generation != cache.generation) {
+                close(cache.logFile);
+                cache.logFile = open((cache.directory + "/log").c_str(), O_RDWR | O_CREAT, 0666);
+                cache.generation = cache.header->generation;
+            }
+        }
+        ~Guard() {
+            flock(cache.indexFile, LOCK_UN);
+        }
+    };
+
+    static uint64_t checksum(const string &bytes) {
+        uint64_t sum = 0xCBF29CE484222325ull;
+        for (unsigned char byte : bytes) {
+            sum = (sum ^ byte) * 0x100000001B3ull;
+        }
+        return sum;
+    }
+    static uint64_t readWord(const string &bytes, uint64_t &position) {
+        uint64_t word = 0;
+        if (position + sizeof(word) <= bytes.size()) {
+            memcpy(&word, bytes.data() + position, sizeof(word));
+        }
+        position += sizeof(word);
+        return word;
+    }
+    //A record is the key's length and bytes, the groups' length and bytes, then a checksum of everything before it
+    static string makeRecord(const string &keyBytes, const vector<vector<Group>> &covers) {
+        string value;
+        FunctionKey::appendWord(value, covers.size());
+        for (const vector<Group> &cover : covers) {
+            FunctionKey::appendWord(value, cover.size());
+            for (const Group &group : cover) {
+                FunctionKey::appendWord(value, group.value);
+                FunctionKey::appendWord(value, group.mask);
+            }
+        }
+        string record;
+        FunctionKey::appendWord(record, keyBytes.size());
+        record += keyBytes;
+        FunctionKey::appendWord(record, value.size());
+        record += value;
+        FunctionKey::appendWord(record, checksum(record));
+        return record;
+    }
+    string readRecord(const Slot &slot) {
+        string record(slot.length, '\0');
+        if (pread(logFile, &record[0], slot.length, slot.offset) != (ssize_t) slot.length) {
+            return "";
+        }
+        return record;
+    }
+    //Reads the groups out of a record, failing if the record is damaged or holds another key
+    static bool parseRecord(const string &record, const string &keyBytes, vector<vector<Group>> &covers) {
+        if (record.size() < 3 * sizeof(uint64_t)) {
+            return false;
+        }
+        uint64_t position = record.size() - sizeof(uint64_t);
+        if (readWord(record, position) != checksum(record.substr(0, record.size() - sizeof(uint64_t)))) {
+            return false;
+        }
+        position = 0;
+        uint64_t keyLength = readWord(record, position);
+        if (keyLength != keyBytes.size() || record.compare(position, keyLength, keyBytes) != 0) {
+            return false;
+        }
+        position += keyLength + sizeof(uint64_t);
+        covers.assign(readWord(record, position), vector<Group>());
+        for (vector<Group> &cover : covers) {
+            uint64_t groupCount = readWord(record, position);
+            for (uint64_t x = 0; x < groupCount && position < record.size(); x++) {
+                uint64_t value = readWord(record, position);
+                uint64_t mask = readWord(record, position);
+                cover.push_back(Group(value, mask));
+            }
+        }
+        return position + sizeof(uint64_t) == record.size();
+    }
+    //Returns the slot of a hash, either holding a record whose key matches or the empty slot where it belongs
+    Slot &findSlot(uint64_t hash, const string &keyBytes, vector<vector<Group>> &covers, bool &found) {
+        found = false;
+        uint64_t x = hash % slotCount;
+        while (slots[x].hash != 0) {
+            if (slots[x].hash == hash && parseRecord(readRecord(slots[x]), keyBytes, covers)) {
+                found = true;
+                break;
+            }
+            x = (x + 1) % slotCount;
+        }
+        return slots[x];
+    }
+    void placeSlot(const Slot &slot) {
+        uint64_t x = slot.hash % slotCount;
+        while (slots[x].hash != 0) {
+            x = (x + 1) % slotCount;
+        }
+        slots[x] = slot;
+    }
+    //Rewrites the log with the most recently used records that fit in keepBytes, dropping the rest
+    void evict(uint64_t keepBytes) {
+        vector<Slot> kept;
+        for (uint64_t x = 0; x < slotCount; x++) {
+            if (slots[x].hash != 0) {
+                kept.push_back(slots[x]);
+            }
+        }
+        sort(kept.begin(), kept.end(), [](const Slot &a, const Slot &b) {return a.lastUse > b.lastUse;});
+        string newPath = directory + "/log.new";
+        int newLog = open(newPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+        if (newLog < 0) {
+            return;
+        }
+        uint64_t bytes = 0;
+        uint64_t count = 0;
+        for (Slot &slot : kept) {
+            string record = readRecord(slot);
+            if (record.empty() || bytes + record.size() > keepBytes || count + 1 > slotCount / 4) {
+                break;
+            }
+            if (pwrite(newLog, record.data(), record.size(), bytes) != (ssize_t) record.size()) {
+                break;
+            }
+            slot.offset = bytes;
+            bytes += record.size();
+            count++;
         }
-        cout << name << flush;
+        kept.resize(count);
+        fsync(newLog);
+        rename(newPath.c_str(), (directory + "/log").c_str());
+        close(logFile);
+        logFile = newLog;
+        memset(slots, 0, slotCount * sizeof(Slot));
+        for (const Slot &slot : kept) {
+            placeSlot(slot);
+        }
+        header->logBytes = bytes;
+        header->entryCount = count;
+        generation = ++header->generation;
     }
-};
 
-//A single cell in the kmap
-struct Cell {
-    //Cell pointers are used to represent adjacencies
-    //A vector must be used to allow for an unknown number of variables
-    string name;
-    int value;
-    Cell *next;
-    int groupsIn = 0;
-    vector<Cell*> adjacencies;
-    vector<BoolVar*> boolVars;
-    Cell(int value) {
-        this->value = value;
-    }
-    void add(Cell *cell) {
-        adjacencies.push_back(cell);
-    }
-    void addVar(BoolVar *boolVar) {
-        boolVars.push_back(boolVar);
+    public:
+    //Opens the cache in directory, creating it if needed, with its log held under maxBytes
+    ResultCache(string directory, uint64_t maxBytes = 64ull << 20) {
+        this->directory = directory;
+        this->maxBytes = maxBytes;
+        mkdir(directory.c_str(), 0777);
+        indexFile = open((directory + "/index").c_str(), O_RDWR | O_CREAT, 0666);
+        if (indexFile < 0) {
+            return;
+        }
+        flock(indexFile, LOCK_EX);
+        mappedBytes = sizeof(Header) + slotCount * sizeof(Slot);
+        struct stat status;
+        bool fresh = fstat(indexFile, &status) != 0 || (uint64_t) status.st_size != mappedBytes;
+        if (fresh && ftruncate(indexFile, mappedBytes) != 0) {
+            flock(indexFile, LOCK_UN);
+            close(indexFile);
+            indexFile = -1;
+            return;
+        }
+        void *mapped = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, indexFile, 0);
+        if (mapped == MAP_FAILED) {
+            flock(indexFile, LOCK_UN);
+            close(indexFile);
+            indexFile = -1;
+            return;
+        }
+        header = (Header *) mapped;
+        slots = (Slot *) (header + 1);
+        logFile = open((directory + "/log").c_str(), O_RDWR | O_CREAT, 0666);
+        //A new or unreadable index, or one written by another version or a machine of the other byte order, starts the cache over
+        if (fresh || header->magic != magic || header->byteOrder != byteOrder || header->version != version || header->slotCount != slotCount) {
+            memset(mapped, 0, mappedBytes);
+            header->magic = magic;
+            header->byteOrder = byteOrder;
+            header->version = version;
+            header->slotCount = slotCount;
+            if (ftruncate(logFile, 0) != 0) {
+                header->magic = 0;
+            }
+        }
+        generation = header->generation;
+        flock(indexFile, LOCK_UN);
     }
-};
-struct Group {
-    string expression;//Boolean expression required to represent the group
-    bool necessary = false;
-    vector<Cell*> elements;
-    void Add(Cell *element) {
-        elements.push_back(element);
+    ~ResultCache() {
+        if (header != nullptr) {
+            munmap(header, mappedBytes);
+        }
+        if (logFile >= 0) {
+            close(logFile);
+        }
+        if (indexFile >= 0) {
+            close(indexFile);
+        }
     }
-    Group(Cell *cell) {
-        Add(cell);
+    bool isOpen() {
+        return header != nullptr && logFile >= 0;
     }
-    Group() {
-        
+    //Fills covers with the groups stored for key, returning whether there were any
+    bool find(const FunctionKey &key, vector<vector<Group>> &covers) {
+        if (!isOpen()) {
+            return false;
+        }
+        Guard guard(*this);
+        bool found;
+        Slot &slot = findSlot(key.hash | (key.hash == 0), key.bytes(), covers, found);
+        if (found) {
+            slot.lastUse = ++header->clock;
+            hits++;
+        }
+        else {
+            misses++;
+        }
+        return found;
     }
-    
-    //For debugging purposes
-    void Print() {
-        int size = elements.size();
-        for (int x = 0; x < size; x++) {
-            cout << elements.at(x)->name << " " << flush;
-            // cout << elements.at(x)->name << " " << elements.at(x)->groupsIn << flush;
+    void insert(const FunctionKey &key, const vector<vector<Group>> &covers) {
+        if (!isOpen()) {
+            return;
         }
-        cout << endl;
+        Guard guard(*this);
+        uint64_t hash = key.hash | (key.hash == 0);
+        string keyBytes = key.bytes();
+        string record = makeRecord(keyBytes, covers);
+        if (record.size() > maxBytes / 2) {
+            return;
+        }
+        vector<vector<Group>> stored;
+        bool found;
+        findSlot(hash, keyBytes, stored, found);
+        //Another process may have stored the same key first
+        if (found) {
+            return;
+        }
+        if (header->logBytes + record.size() > maxBytes || header->entryCount + 1 > slotCount / 2) {
+            evict(maxBytes / 2 - record.size());
+            if (header->entryCount + 1 > slotCount / 2) {
+                return;
+            }
+        }
+        if (pwrite(logFile, record.data(), record.size(), header->logBytes) != (ssize_t) record.size()) {
+            return;
+        }
+        Slot slot;
+        slot.hash = hash;
+        slot.offset = header->logBytes;
+        slot.length = record.size();
+        slot.lastUse = ++header->clock;
+        placeSlot(slot);
+        header->logBytes += record.size();
+        header->entryCount++;
     }
-};
-
-//A single column in a truth table
-struct TruthColumn {
-    //A variable name and a vector of bools representing each case
-    string name;
-    vector<int> values;
-    TruthColumn(string name) {
-        this->name = name;
+    uint64_t hitCount() {
+        return hits;
     }
-    //Adds a value to the column
-    void addValue(int value) {
-        values.push_back(value);
+    uint64_t missCount() {
+        return misses;
     }
 };
-
-//Truth columns organized into a truth table
-class TruthTable {
-    //A vector of truth column inputs and a single output truth column
+#else
+class ResultCache {
     public:
-    vector<TruthColumn*> inputs;
-    TruthColumn *output;
-    //Constructor to build truth table out of a string representing a boolean function
-    TruthTable(string expression) {
-
+    ResultCache(string directory, uint64_t maxBytes = 64ull << 20) {}
+    bool isOpen() {
+        return false;
     }
-    //Constructor to automatically generate input values, assumes output is in binary ascending order
-    TruthTable(vector<string> inputNames, string outputName, vector<int> outputs) {
-        TruthColumn *newTruthColumn;
-        for (string name : inputNames) {
-            inputs.push_back(new TruthColumn(name));
-        }
-        output = new TruthColumn(outputName);
-        output->values = outputs;
-
-        //Add input values in ascending binary order
-        int size = pow(2, inputs.size());
-        int inputNum = inputs.size();
-        int step = size;
-        bool value = true;
-        for (int x = 0; x < inputNum; x++) {
-            step /= 2;
-            for (int y = 0; y < size; y++) {
-                if (y % step == 0) {
-                    value = !value;
-                }
-                inputs.at(x)->addValue(value);
-            }
-        }
+    bool find(const FunctionKey &key, vector<vector<Group>> &covers) {
+        return false;
     }
-    //Returns value of output at an entered index
-    int outputAt(int index) {
-        return output->values.at(index);
+    void insert(const FunctionKey &key, const vector<vector<Group>> &covers) {}
+    uint64_t hitCount() {
+        return 0;
+    }
+    uint64_t missCount() {
+        return 0;
     }
 };
+#endif
+//Result cache code above
+
+//Ways of finding the groups for a kmap
+//GROUPING grows groups from each cell across the kmap's dimensions, QUINE_MCCLUSKEY finds every prime implicant and the fewest covering the kmap
+//ESPRESSO trades the guarantee of a minimal result for speed on large kmaps
+enum Solver {GROUPING, QUINE_MCCLUSKEY, ESPRESSO};
 
 class KarnaughMap {
-    Cell *first;//First cell in linked list of all cells in kmap
-    vector<Cell*> cells;//Vector of all cells in kmap for easier access
-    vector<Group*> groups;//Groups formed in kmap
+    //Cells are implicit: cell m holds output row m, so no per-cell objects or adjacency lists are kept
+    //The neighbor of a cell across variable y is found by flipping bit (varCount - 1 - y)
+    int varCount;
+    uint64_t cellCount;
+    vector<string> names;//Variable names, most significant cell bit first
+    vector<uint64_t> targets;//Cells holding the value being grouped, packed 64 per word
+    vector<uint64_t> dontCares;//Don't care cells, packed 64 per word
+    vector<int> groupsIn;//Number of groups each cell is in while solving
+    vector<Group> groups;//Groups formed in kmap
     string solution = "";
     int method;
-    public:
-
-    //Method to make list of cells
-    void makeCellList(TruthTable* truthTable) {
-        first = new Cell(truthTable->outputAt(0));
-        cells.push_back(first);
-        int cellCount = pow(2, truthTable->inputs.size());
-        for (int x = 1; x < cellCount; x++) {
-            first->next = new Cell(truthTable->outputAt(x));
-            first = first->next;
-            cells.push_back(first);
-        }
-        first = cells.at(0);
-    }
-
-    //Adds boolean variables to each cell
-    void addBools(TruthTable *truthTable) {
-        bool varSign;
-        string varName;
-        Cell *curr = first;
-        int cellCount = cells.size();
-        int varCount = truthTable->inputs.size();
-        for (int x = 0; x < cellCount; x++) {
-            for (int y = 0; y < varCount; y++) {
-                varSign = (bool) truthTable->inputs.at(y)->values.at(x);
-                varName = truthTable->inputs.at(y)->name;
-                curr->addVar(new BoolVar(varName, varSign));
-            }
-            curr = curr->next;
-        }
-    }
-
-    //Rearranges according to kmap convention (i.e. swaps third and fourth row in each dimension)
-    void rearrange() {
-        vector<Cell*> bench;
-        int cellCount = cells.size();
-        int rearrangements = log10(cellCount) / log10(4);
-        int interval;
-        for (int x = 0; x < rearrangements; x++) {
-            interval = 2 * int(pow(4, x));
-            for (int y = 0; y < cellCount;) {
-                y += interval;
-                if (y >= cellCount) {break;}
-                for (int z = 0; z < interval; z++) {
-                    bench.push_back(cells.at(y + z));
-                }
-                for (int a = 0; a < interval / 2; a++) {
-                    cells.at(y + a) = bench.at((interval / 2) + a);
-                }
-                for (int b = interval / 2; b < interval; b++) {
-                    cells.at(y + b) = bench.at(b - (interval / 2));
-                }
-                bench.clear();
-                y += interval;
-            }
-        }
-    }
+    CoverBudget budget;//Limits on the search for a minimum cover of prime implicants
+    int threadCount = 1;//Threads finding prime implicants and reducing their cover
+    bool fromCubes = false;//Whether the kmap was given cubes whose cells are not filled in yet
+    Cover onCubes;//Cells whose output is 1 when given as cubes
+    Cover dcCubes;//Don't care cells when given as cubes
+    ResultCache *cache = nullptr;//Groups found by earlier runs, looked up before solving
+    bool timedOut = false;//Whether the last search for a minimum cover stopped at budget.maxSeconds
+    SolveStats *stats = nullptr;//Times and counts of the phases of solving, if wanted
 
-    //Forms adjacencies
-    void formAdjacendies(TruthTable *truthTable) {
-        vector<Cell*> cellsInverted;
-        int cellCount = cells.size();
-        int varCount = truthTable->inputs.size();
-        for (int x = 0; x < cellCount; x++) {
-            cellsInverted.push_back(cells.at(cellCount - 1 - x));
-        }
-        int interval;
-        int step;
-        int dimCount = ((varCount + 1) / 2);\
-        for (int x = 0; x < dimCount; x++) {
-        step = 0;
-        for (int y = 0; y < cellCount; ) {
-            for (int z = 0; z < pow(4, x); z++) {
-                cells.at(y)->add(cells.at((step + ((int(y + pow(4, x))) % int (pow(4, x + 1)))) % cellCount));
-                y++;
-            }
-            if (int((y) % (int(pow(4, x + 1)))) == 0) {
-                step += pow(4, x + 1);
-            }
-        }
-        step = 0;
-        for (int y = 0; y < cellCount;) {
-            for (int z = 0; z < pow(4, x); z++) {
-                cellsInverted.at(y)->add(cellsInverted.at((step + ((int(y + pow(4, x))) % int (pow(4, x + 1)))) % cellCount));
-                y++;
-            }
-            if (int((y) % (int(pow(4, x + 1)))) == 0) {
-                step += pow(4, x + 1);
-            }
-        }
-    }
+    static bool testBit(const vector<uint64_t> &bits, uint64_t index) {
+        return (bits[index / 64] >> (index % 64)) & 1;
     }
+    public:
 
-    //Names each cell according to the minterm/maxterm number it represents
-    void nameCells() {
-        int cellCount = cells.size();
-        for(int x = 0; x < cellCount; x++) {
-            cells.at(x)->name = to_string(x);
+    //Returns the value of a cell (0, 1 or 2 for don't care)
+    int valueAt(uint64_t cell) {
+        if (testBit(dontCares, cell)) {
+            return 2;
         }
+        return testBit(targets, cell) ? method : !method;
     }
 
     //For debugging purposes
     void print() {
-        for (int x = 0; x < cells.size(); x++) {
-            cout << cells.at(x)->name << " = " << cells.at(x)->value << " -> " << flush;
-            for (int y = 0; y < cells.at(x)->adjacencies.size(); y++) {
-                cout << cells.at(x)->adjacencies.at(y)->name << " = " << cells.at(x)->adjacencies.at(y)->value << " -> " << flush;
+        for (uint64_t x = 0; x < cellCount; x++) {
+            cout << x << " = " << valueAt(x) << " -> " << flush;
+            for (int y = 0; y < varCount; y++) {
+                cout << (x ^ (1ull << y)) << " = " << valueAt(x ^ (1ull << y)) << " -> " << flush;
             }
             cout << endl;
         }
     }
         KarnaughMap(TruthTable* truthTable, int method) {
             this->method = method;//Indicates whether to group 1's (SOP) or 0's (POS)
-            makeCellList(truthTable);//Forms list of cells
-            nameCells();//Names cells in minterm/maxterm order (i.e. 0, 1, 2...etc)
-            addBools(truthTable);//Adds boolean variable representation to each cell in the kmap
-            rearrange();//Rearranges cell order in kmap convention
-            formAdjacendies(truthTable);//Forms appropriate adjacencies between cells
+            varCount = truthTable->inputCount();
+            cellCount = 1ull << varCount;
+            for (int x = 0; x < varCount; x++) {
+                names.push_back(truthTable->inputName(x));
+            }
+            targets = truthTable->packedOutput(method);
+            dontCares = truthTable->packedOutput(2);
+        }
+        //Constructor from cubes, such as lists of minterms, so sparse functions never need a truth table
+        //Espresso minimizes an SOP straight from the cubes, the other solvers fill in the kmap's cells first
+        KarnaughMap(vector<string> names, const Cover &onCubes, const Cover &dcCubes, int method) {
+            this->method = method;
+            this->names = names;
+            varCount = names.size();
+            cellCount = 1ull << varCount;
+            this->onCubes = onCubes;
+            this->dcCubes = dcCubes;
+            fromCubes = true;
         }
 
-        //For debugging purposes
-        void printGroups(vector<Group*> groupsToPrint) {
-            for (int x = 0; x < groupsToPrint.size(); x++) {
-                groupsToPrint.at(x)->Print();
+        //Fills targets and dontCares from the cubes the kmap was given, don't cares winning over 1's
+        void fillCells() {
+            if (!fromCubes) {
+                return;
+            }
+            STATS_PHASE(stats, "fill_cells");
+            if (varCount > 32) {
+                throw invalid_argument("Kmaps of more than 32 variables can only be solved by espresso in SOP form");
+            }
+            dontCares = coverTable(dcCubes, varCount);
+            targets = coverTable(onCubes, varCount);
+            for (uint64_t x = 0; x < targets.size(); x++) {
+                targets[x] = (method == 1 ? targets[x] : ~targets[x]) & ~dontCares[x];
+            }
+            if (cellCount < 64) {
+                targets[0] &= (1ull << cellCount) - 1;
             }
+            fromCubes = false;
+            onCubes = Cover();
+            dcCubes = Cover();
         }
 
-        bool checkExistence(Group *group, int direction, int target) {
-            int groupSize = group->elements.size();
-            Cell *currCell;
-            for (int x = 0; x < groupSize; x++) {
-                currCell = group->elements.at(x)->adjacencies.at(direction);
-                if (currCell->value != target &&  currCell->value != 2) {
-                    return false;
-                }
+        //For debugging purposes
+        void printGroups(const vector<Group> &groupsToPrint) {
+            for (int x = 0; x < groupsToPrint.size(); x++) {
+                groupsToPrint.at(x).Print();
             }
-            return true;
         }
 
-        bool checkExistence(Group *group, int direction, int target, string row) {
-            int groupSize = group->elements.size();
-            Cell *currCell;
-            if (row == "row") {
-                for (int x = 0; x < groupSize; x++) {
-                    currCell = group->elements.at(x)->adjacencies.at(direction);
-                    for (int y = 0; y < 3; y++) {
-                        if (currCell->value != target &&  currCell->value != 2) {
-                            return false;
-                        }
-                        currCell = currCell->adjacencies.at(direction);
-                    }
-                    //return true;
-                }
-                return true;
-            }
-            else {
-                cout << "Invalid input" << endl;
-                return false;
-            }
-            return false;
+        //Checks whether every cell of a group moved across the bits in shift may be grouped
+        bool checkExistence(const Group &group, uint64_t shift) {
+            bool exists = true;
+            group.forEach([&](uint64_t cell) {
+                exists = exists && (testBit(targets, cell ^ shift) || testBit(dontCares, cell ^ shift));
+            });
+            return exists;
         }
 
+        void addGroup(vector<Group> &workingSet, const Group &group) {
+            group.forEach([this](uint64_t cell) {groupsIn[cell]++;});
+            workingSet.push_back(group);
+        }
 
         void makeGroups() {
             //Loop through every cell in the kmap
             //If the cell has not been grouped, make a new group of that singular cell
             //After the formation of the initial singular-cell group, try to extend that new group across a dimension to form a new group
             //repeat for each dimension
-            vector<Group*> workingSet;
-            Cell *curr = first;
-            int workingSetSize = 0;
-            int dimCount = cells.at(0)->adjacencies.size() / 2;
-            Group *newGroup;
-            bool twoLong;
-            while (curr != nullptr) {
-                if (curr->groupsIn == 0 && curr->value == method) {
-                    workingSet.push_back((new Group(curr)));
-                    curr->groupsIn++; workingSetSize++;
-                    //Extend all groups in working set through every dimension
-
-                    //For every dimension
-                        //For every group in working set, extend through current dimension
-                    for (int x = 0; x < dimCount; x++) {
-                        for (int y = 0; y < workingSetSize; y++) {
-                            twoLong = (workingSet.at(y)->elements.at(0)->name == workingSet.at(y)->elements.at(0)->adjacencies.at(2*x)->adjacencies.at(2*x)->name);
-                            if (checkExistence(workingSet.at(y), 2*x + 1, method) && !twoLong) {
-                                newGroup = new Group();
-                                for (int z = 0; z < workingSet.at(y)->elements.size(); z++) {
-                                    newGroup->Add(workingSet.at(y)->elements.at(z));
-                                    workingSet.at(y)->elements.at(z)->groupsIn++;
-                                    newGroup->Add(workingSet.at(y)->elements.at(z)->adjacencies.at(2*x + 1));
-                                    workingSet.at(y)->elements.at(z)->adjacencies.at(2*x + 1)->groupsIn++;
-                                }
-                                workingSet.push_back(newGroup);
-                            }
-                            if (checkExistence(workingSet.at(y), 2*x, method)) {
-                                newGroup = new Group();
-                                for (int z = 0; z < workingSet.at(y)->elements.size(); z++) {
-                                    newGroup->Add(workingSet.at(y)->elements.at(z));
-                                    workingSet.at(y)->elements.at(z)->groupsIn++;
-                                    newGroup->Add(workingSet.at(y)->elements.at(z)->adjacencies.at(2*x));
-                                    workingSet.at(y)->elements.at(z)->adjacencies.at(2*x)->groupsIn++;
-                                }
-                                workingSet.push_back(newGroup);
-                            }
-                            if (checkExistence(workingSet.at(y), 2*x, method, "row") && !twoLong) {
-                                newGroup = new Group();
-                                for (int z = 0; z < workingSet.at(y)->elements.size(); z++) {
-                                    //Need to fix 
-                                    newGroup->Add(workingSet.at(y)->elements.at(z));
-                                    workingSet.at(y)->elements.at(z)->groupsIn++;
-                                    newGroup->Add(workingSet.at(y)->elements.at(z)->adjacencies.at(2*x));
-                                    workingSet.at(y)->elements.at(z)->adjacencies.at(2*x)->groupsIn++;
-                                    newGroup->Add(workingSet.at(y)->elements.at(z)->adjacencies.at(2*x)->adjacencies.at(2*x));
-                                    workingSet.at(y)->elements.at(z)->adjacencies.at(2*x)->adjacencies.at(2*x)->groupsIn++;
-                                    newGroup->Add(workingSet.at(y)->elements.at(z)->adjacencies.at(2*x)->adjacencies.at(2*x)->adjacencies.at(2*x));
-                                    workingSet.at(y)->elements.at(z)->adjacencies.at(2*x)->adjacencies.at(2*x)->adjacencies.at(2*x)->groupsIn++;
-                                    //Need to fix
-                                }
-                                workingSet.push_back(newGroup);
-                            }
+            //Dimension x spans cell bits 2x and 2x + 1, laid out in the gray code order 00, 01, 11, 10
+            //When varCount is odd the last dimension has a single bit and is only two cells long
+            vector<Group> workingSet;
+            int dimCount = (varCount + 1) / 2;
+            for (uint64_t cell = 0; cell < cellCount; cell++) {
+                if (groupsIn[cell] != 0 || !testBit(targets, cell)) {
+                    continue;
+                }
+                addGroup(workingSet, Group(cell, 0));
+                //Extend all groups in working set through every dimension
+                for (int x = 0; x < dimCount; x++) {
+                    uint64_t low = 1ull << (2*x);
+                    uint64_t high = 2*x + 1 < varCount ? 1ull << (2*x + 1) : 0;
+                    bool twoLong = high == 0;
+                    int workingSetSize = workingSet.size();
+                    for (int y = 0; y < workingSetSize; y++) {
+                        Group group = workingSet.at(y);
+                        //Stepping forward through the gray code flips the low bit from 00 and 11 and the high bit from 01 and 10
+                        bool bitsMatch = ((group.value & low) != 0) == ((group.value & high) != 0);
+                        uint64_t forward = (twoLong || bitsMatch) ? low : high;
+                        uint64_t backward = forward ^ low ^ high;
+                        if (!twoLong && checkExistence(group, backward)) {
+                            addGroup(workingSet, group.extend(backward));
+                        }
+                        if (checkExistence(group, forward)) {
+                            addGroup(workingSet, group.extend(forward));
+                        }
+                        if (!twoLong && checkExistence(group, low) && checkExistence(group, high) && checkExistence(group, low | high)) {
+                            addGroup(workingSet, group.extend(low | high));
                         }
-                        workingSetSize = workingSet.size();
                     }
-                    //====================================================================
-                for (int x = 0; x < workingSet.size(); x++) {
-                    groups.push_back(workingSet.at(x));
                 }
-                workingSet.clear(); workingSetSize = 0;
-                }
-                curr = curr->next;
-                
+                groups.insert(groups.end(), workingSet.begin(), workingSet.end());
+                workingSet.clear();
             }
             // printGroups(groups);
         }
 
         void removeUnnecessaryGroups() {
-            vector<Group*> allGroups;
-            int size = groups.size();
-            for (int x = 0; x < size; x++) {
-                allGroups.push_back(groups.at(x));
-            }
-            groups.clear();
+            vector<Group> allGroups;
+            allGroups.swap(groups);
             bool end = false;
-            bool alreadyAdded = false;
-            for (int x = 1; x > 0; x *= 2) {
+            for (uint64_t x = 1; x > 0; x *= 2) {
                 if (end) {break;}
                 end = true;
-                for (int y = 0; y < size; y++) {
-                    if (allGroups.at(y)->elements.size() == x) {
-                        alreadyAdded = false;
-                        for (int z = 0; z < x; z++) {
-                            if (allGroups.at(y)->elements.at(z)->groupsIn == 1 && !alreadyAdded) {
-                                groups.push_back(allGroups.at(y));
-                                alreadyAdded = true;
-                            }
+                for (const Group &group : allGroups) {
+                    if (group.size() == x) {
+                        bool necessary = false;
+                        group.forEach([&](uint64_t cell) {necessary = necessary || groupsIn[cell] == 1;});
+                        if (necessary) {
+                            groups.push_back(group);
                         }
-                        if (!alreadyAdded) {
-                            for (int z = 0; z < x; z++) {
-                                allGroups.at(y)->elements.at(z)->groupsIn--;
-                            }
+                        else {
+                            group.forEach([this](uint64_t cell) {groupsIn[cell]--;});
                         }
                         end = false;
                     }
@@ -400,8 +2405,6 @@ class KarnaughMap {
         }
         void getSolution() {
             int groupNum = groups.size();
-            int varNum = cells.at(0)->boolVars.size();
-            int groupSize;
             bool firstTerm;
             //If there are no groups, output is either always 0 or 1
             if (groups.size() == 0) {
@@ -414,7 +2417,7 @@ class KarnaughMap {
                 return;
             }
             //If there is one group containing all the cells, the output is either always 0 or 1
-            else if (groups.size() == 1 && groups.at(0)->elements.size() == cells.size()) {
+            else if (groups.size() == 1 && groups.at(0).size() == cellCount) {
                 if (method == 1) {
                     solution = "1";
                 }
@@ -428,48 +2431,193 @@ class KarnaughMap {
                 if (method == 0) {
                     solution += "(";
                 }
-                for (int y = 0; y < varNum; y++) {
-                    groupSize = groups.at(x)->elements.size();
-                    for (int z = 0; z < groupSize; z++) {
-                        if (groups.at(x)->elements.at(0)->boolVars.at(y)->sign != groups.at(x)->elements.at(z)->boolVars.at(y)->sign) {
-                            break;
-                        }
-                        if (z == groupSize - 1) {
-                            if (!firstTerm && method == 0) {
-                                solution += " + ";
-                            }
-                            if ((!groups.at(x)->elements.at(z)->boolVars.at(y)->sign && method == 1) || (groups.at(x)->elements.at(z)->boolVars.at(y)->sign && method == 0)) {
-                                solution += "~";
-                            }
-                            
-                            firstTerm = false;
-                            solution += groups.at(x)->elements.at(z)->boolVars.at(y)->name;
-                        }
+                for (int y = 0; y < varCount; y++) {
+                    uint64_t bit = 1ull << (varCount - 1 - y);
+                    //Variables whose bit differs within the group are eliminated
+                    if (groups.at(x).mask & bit) {
+                        continue;
+                    }
+                    bool sign = (groups.at(x).value & bit) != 0;
+                    if (!firstTerm && method == 0) {
+                        solution += " + ";
+                    }
+                    if ((!sign && method == 1) || (sign && method == 0)) {
+                        solution += "~";
                     }
-                    
+                    firstTerm = false;
+                    solution += names.at(y);
                 }
                 if (x != groupNum - 1 && method == 1) {
                     solution += " + ";
                 }
                 if (method == 0) {
                     solution += ")";
-                }                            
+                }
             }
         }
-        void solve() {
-            makeGroups();//Make all possible groups
-            removeUnnecessaryGroups();//Removes unnecessary groups
+        void setBudget(CoverBudget budget) {
+            this->budget = budget;
+        }
+        void setThreads(int threadCount) {
+            this->threadCount = threadCount;
+        }
+        void setCache(ResultCache *cache) {
+            this->cache = cache;
+        }
+        void setStats(SolveStats *stats) {
+            this->stats = stats;
+        }
+        void solve(Solver solver = GROUPING) {
+            groups.clear();
+            solution = "";
+            timedOut = false;
+            if (cache == nullptr || (fromCubes && solver == ESPRESSO && method == 1)) {
+                findGroups(solver);
+            }
+            else {
+                //The groups depend only on the cells, the solver and, for QUINE_MCCLUSKEY, the budget, so the kmap's names and form are left out of the key
+                fillCells();
+                FunctionKey key(varCount, solver, solver == QUINE_MCCLUSKEY ? budget : CoverBudget());
+                vector<vector<Group>> found;
+                bool hit;
+                {
+                    STATS_PHASE(stats, "cache_lookup");
+                    key.addFunction(targets, dontCares);
+                    key.finish();
+                    hit = cache->find(key, found);
+                }
+                STATS_COUNT(stats, hit ? "cache_hits" : "cache_misses", 1);
+                if (hit) {
+                    groups = found.at(0);
+                }
+                else {
+                    findGroups(solver);
+                    //A search cut short by the clock could find more on a faster or less busy machine, so only repeatable results are kept
+                    if (!timedOut) {
+                        STATS_PHASE(stats, "cache_insert");
+                        cache->insert(key, {groups});
+                    }
+                }
+            }
+#if KMAP_STATS
+            if (stats != nullptr) {
+                uint64_t literals = 0;
+                for (const Group &group : groups) {
+                    literals += varCount - popcount64(group.mask);
+                }
+                stats->count("groups", groups.size());
+                stats->count("literals", literals);
+            }
+#endif
+            STATS_PHASE(stats, "solution");
             getSolution();//Uses essential groups to solve for solution
         }
+        //Finds the kmap's groups with the chosen solver
+        void findGroups(Solver solver) {
+            //Cubes given for the 1's are already a cover, so espresso needs no cells to solve an SOP
+            bool sparse = fromCubes && solver == ESPRESSO && method == 1;
+            if (!sparse) {
+                fillCells();
+            }
+#if KMAP_STATS
+            if (stats != nullptr && !sparse) {
+                uint64_t targetCells = 0;
+                uint64_t dontCareCells = 0;
+                for (uint64_t x = 0; x < targets.size(); x++) {
+                    targetCells += popcount64(targets[x]);
+                    dontCareCells += popcount64(dontCares[x]);
+                }
+                stats->count("cells", cellCount);
+                stats->count("target_cells", targetCells);
+                stats->count("dont_care_cells", dontCareCells);
+            }
+#endif
+            if (sparse) {
+                STATS_COUNT(stats, "on_cubes", onCubes.size());
+                STATS_COUNT(stats, "dont_care_cubes", dcCubes.size());
+                STATS_PHASE(stats, "espresso");
+                groups = espresso(onCubes, dcCubes, varCount);
+            }
+            else if (solver == ESPRESSO) {
+                //Espresso's cover is already irredundant, so it goes straight to the solution
+                STATS_PHASE(stats, "espresso");
+                Espresso minimizer(targets, dontCares, varCount);
+                groups = minimizer.minimize();
+            }
+            else if (solver == QUINE_MCCLUSKEY) {
+                //Find all prime implicants, then the fewest of them covering every cell
+                WorkPool pool(threadCount);
+                vector<Group> primes;
+                {
+                    STATS_PHASE(stats, "prime_implicants");
+                    primes = primeImplicants(targets, dontCares, varCount, &pool);
+                }
+                STATS_COUNT(stats, "prime_implicants", primes.size());
+                groups = minimumCover(primes, targets, cellCount, budget, &pool, stats, &timedOut);
+            }
+            else {
+                groupsIn.assign(cellCount, 0);
+                {
+                    STATS_PHASE(stats, "make_groups");
+                    makeGroups();//Make all possible groups
+                }
+                STATS_COUNT(stats, "groups_made", groups.size());
+                {
+                    STATS_PHASE(stats, "remove_groups");
+                    removeUnnecessaryGroups();//Removes unnecessary groups
+                }
+                groupsIn = vector<int>();
+            }
+        }
+        //Changes cells of a solved kmap and repairs its groups around them instead of solving it again
+        //Cells are given as changes to the ON-set and DC-set, whichever form the kmap is in
+        void update(const TableDelta &delta) {
+            fillCells();
+            vector<uint64_t> addOn = coverTable(delta.addOn, varCount);
+            vector<uint64_t> removeOn = coverTable(delta.removeOn, varCount);
+            vector<uint64_t> addDontCare = coverTable(delta.addDontCare, varCount);
+            vector<uint64_t> removeDontCare = coverTable(delta.removeDontCare, varCount);
+            uint64_t last = cellCount < 64 ? (1ull << cellCount) - 1 : ~0ull;//Cells of the last word inside the kmap
+            vector<uint64_t> nextTargets(targets.size());
+            vector<uint64_t> nextDontCares(targets.size());
+            vector<uint64_t> changed(targets.size());
+            for (uint64_t x = 0; x < targets.size(); x++) {
+                uint64_t inside = x == targets.size() - 1 ? last : ~0ull;
+                uint64_t on = method == 1 ? targets[x] : ~targets[x] & ~dontCares[x] & inside;
+                nextDontCares[x] = (dontCares[x] & ~removeDontCare[x]) | addDontCare[x];
+                on = ((on & ~removeOn[x]) | addOn[x]) & ~nextDontCares[x];
+                nextTargets[x] = method == 1 ? on : ~on & ~nextDontCares[x] & inside;
+                changed[x] = (targets[x] ^ nextTargets[x]) | (dontCares[x] ^ nextDontCares[x]);
+            }
+            targets.swap(nextTargets);
+            dontCares.swap(nextDontCares);
+            WorkPool pool(threadCount);
+            groups = repairCover(groups, targets, dontCares, changed, varCount, budget, &pool);
+            solution = "";
+            getSolution();
+        }
+        //Uses groups chosen elsewhere, such as a cover shared with other kmaps, as the solution
+        void solveWith(const vector<Group> &chosen) {
+            groups = chosen;
+            solution = "";
+            getSolution();
+        }
         void printSolution() {
             cout << solution << endl;
         }
         string returnSolution() {
             return solution;
         }
+        vector<Group> returnGroups() {
+            return groups;
+        }
+        int returnVarCount() {
+            return varCount;
+        }
 };
 
-string simplify(vector<string> inputs, string outputs) {
+//Reads a function's truth table from a string of 0, 1 and 2 for don't care, skipping any other characters
+vector<int> outputValues(string outputs) {
     vector<int> outputVector;
     for (int x = 0; x < outputs.size(); x++) {
         if (outputs.at(x) == '0') {
@@ -482,10 +2630,153 @@ string simplify(vector<string> inputs, string outputs) {
             outputVector.push_back(2);
         }
     }
-    TruthTable *truthTable = new TruthTable(inputs, "f", outputVector);
-    KarnaughMap *kmap = new KarnaughMap(truthTable, 1);
-    kmap->solve();
-    return kmap->returnSolution();
+    return outputVector;
+}
+
+//Simplify cache code below
+//FSM synthesis keeps simplifying the same functions, such as output columns that match or J and K columns that coincide
+//Functions are looked up by their packed ON and DC planes, so a repeated function costs a hash of its planes
+//Entries hold groups rather than solutions, so a function of differently named inputs is found too
+//Given a ResultCache, functions missing from memory are looked for on disk and new ones are kept there for later runs
+//Safe to share between threads, two threads missing on the same function both solve it and either result is kept
+class SimplifyCache {
+    mutex lock;
+    unordered_map<FunctionKey, vector<vector<Group>>, FunctionKeyHash> entries;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    ResultCache *disk = nullptr;
+    public:
+    void setDiskCache(ResultCache *disk) {
+        lock_guard<mutex> guard(lock);
+        this->disk = disk;
+    }
+    bool find(const FunctionKey &key, vector<vector<Group>> &covers) {
+        lock_guard<mutex> guard(lock);
+        auto entry = entries.find(key);
+        if (entry != entries.end()) {
+            hits++;
+            covers = entry->second;
+            return true;
+        }
+        if (disk != nullptr && disk->find(key, covers)) {
+            hits++;
+            entries[key] = covers;
+            return true;
+        }
+        misses++;
+        return false;
+    }
+    void insert(const FunctionKey &key, const vector<vector<Group>> &covers) {
+        lock_guard<mutex> guard(lock);
+        entries[key] = covers;
+        if (disk != nullptr) {
+            disk->insert(key, covers);
+        }
+    }
+    uint64_t hitCount() {
+        lock_guard<mutex> guard(lock);
+        return hits;
+    }
+    uint64_t missCount() {
+        lock_guard<mutex> guard(lock);
+        return misses;
+    }
+    void clear() {
+        lock_guard<mutex> guard(lock);
+        entries.clear();
+        hits = 0;
+        misses = 0;
+    }
+};
+
+SimplifyCache &simplifyCache() {
+    static SimplifyCache cache;
+    return cache;
+}
+//Simplify cache code above
+
+string simplify(vector<string> inputs, string outputs, Solver solver = GROUPING) {
+    TruthTable truthTable(inputs, "f", outputValues(outputs));
+    KarnaughMap kmap(&truthTable, 1);
+    FunctionKey key(inputs.size(), solver, CoverBudget());
+    key.addFunction(truthTable.packedOutput(1), truthTable.packedOutput(2));
+    key.finish();
+    vector<vector<Group>> covers;
+    if (simplifyCache().find(key, covers)) {
+        kmap.solveWith(covers.at(0));
+    }
+    else {
+        kmap.solve(solver);
+        simplifyCache().insert(key, {kmap.returnGroups()});
+    }
+    return kmap.returnSolution();
+}
+
+//Covers of functions of the same inputs minimized together by multipleOutputCover, looked up in the simplify cache first
+vector<vector<Group>> sharedCovers(int varCount, const vector<vector<uint64_t>> &targets, const vector<vector<uint64_t>> &dontCares, CoverBudget budget) {
+    FunctionKey key(varCount, -1, budget);
+    for (int x = 0; x < targets.size(); x++) {
+        key.addFunction(targets.at(x), dontCares.at(x));
+    }
+    key.finish();
+    vector<vector<Group>> covers;
+    if (!simplifyCache().find(key, covers)) {
+        covers = multipleOutputCover(targets, dontCares, varCount, budget);
+        simplifyCache().insert(key, covers);
+    }
+    return covers;
+}
+
+//Cost of building every cover in one circuit, a product used by several covers is only formed once
+//Covers are compared by number of distinct products, then by the literals of those products
+pair<uint64_t, uint64_t> circuitCost(const vector<vector<Group>> &covers, int varCount) {
+    unordered_set<Group, GroupHash> products;
+    uint64_t literals = 0;
+    for (const vector<Group> &cover : covers) {
+        for (const Group &group : cover) {
+            if (products.insert(group).second) {
+                literals += varCount - popcount64(group.mask);
+            }
+        }
+    }
+    return make_pair((uint64_t) products.size(), literals);
+}
+
+//Simplifies several functions of the same inputs together, so a product they have in common is only formed once
+//Sharing can leave an output with more than its own minimum, as a product it could have merged is one another output needs
+//Each output's own minimum is found by the same search under the same budget, and the shared covers are only kept
+//when they make the circuit as a whole smaller, and then notMinimal, if given, is set when some output is larger than its own minimum
+//Returns the solution of each function in the order of outputs
+vector<string> simplifyAll(vector<string> inputs, vector<string> outputs, CoverBudget budget = CoverBudget(), bool *notMinimal = nullptr) {
+    vector<unique_ptr<TruthTable>> truthTables;
+    vector<vector<uint64_t>> targets;
+    vector<vector<uint64_t>> dontCares;
+    for (int x = 0; x < outputs.size(); x++) {
+        truthTables.push_back(unique_ptr<TruthTable>(new TruthTable(inputs, "f", outputValues(outputs.at(x)))));
+        targets.push_back(truthTables.back()->packedOutput(1));
+        dontCares.push_back(truthTables.back()->packedOutput(2));
+    }
+    vector<string> solutions;
+    if (outputs.empty()) {
+        return solutions;
+    }
+    vector<vector<Group>> covers = sharedCovers(inputs.size(), targets, dontCares, budget);
+    vector<vector<Group>> separate;
+    for (int x = 0; x < outputs.size(); x++) {
+        separate.push_back(sharedCovers(inputs.size(), {targets.at(x)}, {dontCares.at(x)}, budget).at(0));
+    }
+    if (circuitCost(separate, inputs.size()) <= circuitCost(covers, inputs.size())) {
+        covers = separate;
+    }
+    for (int x = 0; x < outputs.size(); x++) {
+        if (notMinimal != nullptr && circuitCost({covers.at(x)}, inputs.size()) > circuitCost({separate.at(x)}, inputs.size())) {
+            *notMinimal = true;
+        }
+        KarnaughMap kmap(truthTables.at(x).get(), 1);
+        kmap.solveWith(covers.at(x));
+        solutions.push_back(kmap.returnSolution());
+    }
+    return solutions;
 }
 //kmap solver code above
 
@@ -494,142 +2785,118 @@ string simplify(vector<string> inputs, string outputs) {
 
 
 //Boolean Expression solver code below
-struct charElement {
-    char value;
-    charElement *next;
-    charElement *prev;
-    charElement(char enValue) {
-        value = enValue;
-    }
+//Evaluates an expression made only of 1, 0, +, ~ and parentheses in a single left-to-right pass
+//Each open parenthesis saves the enclosing sum and product on an explicit stack, so time is linear and nesting never recurses
+//Products bind tighter than sums, so "1+10" is 1 + (10)
+struct ParenFrame {
+    int sum;//OR of the finished products at this level
+    int product;//AND of the factors so far in the current product
+    bool negate;//Whether the parenthesized factor that opened the next level is negated
 };
 
+int solve(const string &expression) {
+    if (expression.empty()) {
+        throw invalid_argument("Empty expression");
+    }
+    vector<ParenFrame> frames;
+    int sum = 0;
+    int product = 1;
+    bool negate = false;//Pending '~' for the next factor
+    for (char c : expression) {
+        if (c == '~') {
+            negate = !negate;
+        }
+        else if (c == '0' || c == '1') {
+            product &= (c - '0') ^ negate;
+            negate = false;
+        }
+        else if (c == '+') {
+            sum |= product;
+            product = 1;
+            negate = false;
+        }
+        else if (c == '(') {
+            frames.push_back({sum, product, negate});
+            sum = 0;
+            product = 1;
+            negate = false;
+        }
+        else if (c == ')') {
+            if (frames.empty()) {
+                throw invalid_argument("Unmatched ')' in expression: " + expression);
+            }
+            int value = sum | product;
+            ParenFrame frame = frames.back();
+            frames.pop_back();
+            sum = frame.sum;
+            product = frame.product & (value ^ frame.negate);
+            negate = false;
+        }
+    }
+    if (!frames.empty()) {
+        throw invalid_argument("Missing ')' in expression: " + expression);
+    }
+    return sum | product;
+}
 
-
-int solve(charElement* start, charElement* end) {
-    charElement *one = start;
-    charElement *curr = start;
-    int total = 1;
-    int parenCount = 0;
-    bool add = false;
-    bool tilde = false;
-    charElement *closeParen;
-    while (curr != end->next) {
-        if (curr->value == '+') {
-            add = true;
-            curr = curr->next;
-        }
-        if (curr->value == '~') {
-            tilde = true;
-            curr = curr->next;
-        }
-        if (curr->value == '(') {
-            closeParen = curr;
-            while (closeParen != nullptr) {
-                if (closeParen->value == '(') {
-                    parenCount++;
-                }
-                else if (closeParen->value == ')') {
-                    parenCount--;
-                }
-                if (parenCount == 0) {
-                    if (add) {
-                        if (tilde) {
-                            total += ((solve(curr->next, closeParen->prev) + 1) % 2);
-                        }
-                        else {
-                            total += solve(curr->next, closeParen->prev);
-                        }
-                    }
-                    else {
-                        if (tilde) {
-                            total *= ((solve(curr->next, closeParen->prev) + 1) % 2);
-                        }
-                        else {
-                            total *= solve(curr->next, closeParen->prev);
-                        }
-                    }
-                    curr->next = closeParen->next;
-                    break;
-                }
-                closeParen = closeParen->next;
+//Variable names interned into dense ids, where id x is the name at index x of the list it was built from
+//Names are stored in a trie, so the longest name starting at any position is found in one pass over its characters
+class SymbolTable {
+    struct Node {
+        vector<pair<char, int>> children;//Next character and the index of its node
+        int id = -1;//Id of the name ending at this node
+    };
+    vector<Node> nodes;
+    int findChild(int node, char c) const {
+        for (const pair<char, int> &child : nodes[node].children) {
+            if (child.first == c) {
+                return child.second;
             }
         }
-        else {
-            if (curr->value == '1') {
-                if (add) {
-                    if (tilde) {
-                        total += 0;
-                    }
-                    else {
-                        total += 1;
-                    }
-                 }
-                else {
-                    if (tilde) {
-                        total *= 0;
-                    }
-                    else {
-                        total *= 1;
-                    }
+        return -1;
+    }
+
+    public:
+    SymbolTable(const vector<string> &names) {
+        nodes.emplace_back();
+        for (int x = 0; x < names.size(); x++) {
+            int node = 0;
+            for (char c : names.at(x)) {
+                int next = findChild(node, c);
+                if (next < 0) {
+                    next = nodes.size();
+                    nodes[node].children.push_back({c, next});
+                    nodes.emplace_back();
                 }
+                node = next;
             }
-            else if (curr->value == '0') {
-                if (add) {
-                    if (tilde) {
-                        total += 1;
-                    }
-                    else {
-                        total += 0;
-                    }
-                }
-                else {
-                    if (tilde) {
-                        total *= 1;
-                    }
-                    else {
-                        total *= 0;
-                    }
-                }
+            //The first of any repeated names keeps the id, and an empty name is never matched
+            if (node != 0 && nodes[node].id < 0) {
+                nodes[node].id = x;
             }
         }
-        curr = curr->next;
-        add = false;
-        tilde = false;
     }
-    if (total > 0) {
-        return 1;
-    }
-    else {
-        return 0;
+    //Returns the id of the longest name starting at pos in text and sets length to its size, or -1 if none starts there
+    int match(const string &text, int pos, int &length) const {
+        int best = -1;
+        length = 0;
+        int node = 0;
+        for (int x = pos; x < text.size(); x++) {
+            node = findChild(node, text[x]);
+            if (node < 0) {
+                break;
+            }
+            if (nodes[node].id >= 0) {
+                best = nodes[node].id;
+                length = x - pos + 1;
+            }
+        }
+        return best;
     }
-}
-
-int makeList(string expression) {
-    charElement *curr;
-    charElement *prevCurr;
-    charElement *first;
-    charElement *last;
-    first = new charElement(expression.at(0));
-    curr = first;
-    for (int x = 1; x < expression.size(); x++) {        
-        curr->next = new charElement(expression.at(x));
-        curr = curr->next;
-    }
-    curr->next = nullptr;
-    last = curr;
-
-    curr = first;
-    first->prev = nullptr;
-    prevCurr = curr->next;
-    while (prevCurr != nullptr) {
-        prevCurr->prev = curr;
-        prevCurr = prevCurr->next;
-        curr = curr->next;
-    }
-    return solve(first, last);
-}
+};
 
-string makeMathExp(string expression, vector<string> inputNames, vector<int> inputVals) {
+//Variable names are looked up in a symbol table built once by the caller
+string makeMathExp(string expression, const SymbolTable &symbols, vector<int> inputVals) {
     //First turn the boolean expression into a math expression using the given inputs
     string mathExpression = "";
     
@@ -643,20 +2910,17 @@ string makeMathExp(string expression, vector<string> inputNames, vector<int> inp
             }
         }
 
-        string currVar;
+        //Replace the longest variable name at each position with its value
+        //Any other character that is not part of the expression syntax is dropped
         string newExpression = "";
+        int length;
         for (int x = 0; x < mathExpression.size(); x++) {  
-            if (mathExpression.at(x) != '(' && mathExpression.at(x) != ')' && mathExpression.at(x) != '1' && mathExpression.at(x) != '0' && mathExpression.at(x) != '+' && mathExpression.at(x) != '~') {
-                currVar += mathExpression.at(x);
-                for (int y = 0; y < inputNames.size(); y++) {
-                    if (currVar == inputNames.at(y)) {
-                        newExpression += to_string(inputVals.at(y));
-                        currVar = "";
-                        break;
-                    }
-                }
+            int id = symbols.match(mathExpression, x, length);
+            if (id >= 0) {
+                newExpression += inputVals.at(id) ? '1' : '0';
+                x += length - 1;
             }
-            else {
+            else if (mathExpression.at(x) == '(' || mathExpression.at(x) == ')' || mathExpression.at(x) == '1' || mathExpression.at(x) == '0' || mathExpression.at(x) == '+' || mathExpression.at(x) == '~') {
                 newExpression += mathExpression.at(x);
             }
         }
@@ -664,7 +2928,11 @@ string makeMathExp(string expression, vector<string> inputNames, vector<int> inp
         return newExpression;
 };
 
-int eval(string expression, vector<string> inputNames, vector<bool> inputVals) {
+string makeMathExp(string expression, vector<string> inputNames, vector<int> inputVals) {
+    return makeMathExp(expression, SymbolTable(inputNames), inputVals);
+};
+
+int eval(string expression, const SymbolTable &symbols, vector<bool> inputVals) {
     vector<int> inputs;
     for (int x = 0; x < inputVals.size(); x++) {
         if (inputVals.at(x)) {
@@ -674,7 +2942,11 @@ int eval(string expression, vector<string> inputNames, vector<bool> inputVals) {
             inputs.push_back(0);
         }
     }
-    return makeList(makeMathExp(expression, inputNames, inputs));
+    return solve(makeMathExp(expression, symbols, inputs));
+};
+
+int eval(string expression, vector<string> inputNames, vector<bool> inputVals) {
+    return eval(expression, SymbolTable(inputNames), inputVals);
 };
 //Boolean Expression solver code above
 
@@ -738,12 +3010,12 @@ class BubbleDiagram {
     }
 };
 
-int findValid(vector<string> conditions, vector<bool> inputs, vector<string> listOfInputs) {
+int findValid(vector<string> conditions, vector<bool> inputs, const SymbolTable &inputSymbols) {
     //Determine which condition evaluates to true given the inputs
 
 
     for (int x = 0; x < conditions.size(); x++) {
-        if (eval(conditions.at(x), listOfInputs, inputs) == 1) {
+        if (eval(conditions.at(x), inputSymbols, inputs) == 1) {
             return x;
         }
     }
@@ -752,12 +3024,15 @@ int findValid(vector<string> conditions, vector<bool> inputs, vector<string> lis
 
 class StateTransitionTable {
     vector<string> inputs;//Input signal names
+    SymbolTable inputSymbols;//Input signal names interned once for evaluating conditions
     vector<string> outputs;//Output signal names
     vector<State*> states;
     vector<string> ffdata;//Outputs to be kmapped into functions for flip flop inputs
     vector<string> outputData;//Truth table data for output signals to be kmapped
     vector<string> inputExpressions;
     vector<string> outputExpressions;
+    CoverBudget coverBudget;//Limits the search for the fewest products shared by the expressions
+    bool notMinimal = false;//Whether sharing products left some expression larger than its own minimum
     public:
     int getNextStateQVal(int qNum, int stateNum, int condition) {
         vector<bool> inputValues;
@@ -777,7 +3052,7 @@ class StateTransitionTable {
             step /= 2;
         }
 
-        int result = states.at(stateNum)->destinations.at(findValid(states.at(stateNum)->conditions, inputValues, inputs))->qval.at(qNum);
+        int result = states.at(stateNum)->destinations.at(findValid(states.at(stateNum)->conditions, inputValues, inputSymbols))->qval.at(qNum);
         return result;
 
         // for (int x = 0; x < inputNum; x++) {
@@ -841,6 +3116,7 @@ class StateTransitionTable {
         //For every flip flop
         for (int x = 0; x < ffnum; x++) {
             data = "";
+            data2 = "";
             //For every state
             for (int y = 0; y < maxNumOfStates; y++) {
                 //For every possible combination of inputs
@@ -914,7 +3190,7 @@ class StateTransitionTable {
             inputValues.push_back(value);
             step /= 2;
         }
-        int result = states.at(stateNum)->outputVals.at(findValid(states.at(stateNum)->outputConditions, inputValues, inputs)).at(outputNum);
+        int result = states.at(stateNum)->outputVals.at(findValid(states.at(stateNum)->outputConditions, inputValues, inputSymbols)).at(outputNum);
         return result;
     }
     void getOutputData() {
@@ -950,9 +3226,7 @@ class StateTransitionTable {
             kmapInputs.push_back(inputs.at(x));
 
         }
-        for (int x = 0; x < ffdata.size(); x++) {
-            inputExpressions.push_back(simplify(kmapInputs, ffdata.at(x)));
-        }
+        inputExpressions = simplifyAll(kmapInputs, ffdata, coverBudget, &notMinimal);
     }
     void getOutputExpressions() {
         vector<string> kmapInputs;
@@ -963,9 +3237,7 @@ class StateTransitionTable {
         for (int x = 0; x < inputs.size(); x++) {
             kmapInputs.push_back(inputs.at(x));
         }
-        for (int x = 0; x < outputData.size(); x++) {
-            outputExpressions.push_back(simplify(kmapInputs, outputData.at(x)));
-        }
+        outputExpressions = simplifyAll(kmapInputs, outputData, coverBudget, &notMinimal);
     }
     void printSolution(string ffType) {
         cout << "Input:" << endl;
@@ -985,11 +3257,15 @@ class StateTransitionTable {
         for (int x = 0; x < outputExpressions.size(); x++) {
             cout << outputs.at(x) << ":\t" << outputExpressions.at(x) << endl;
         }
+        if (notMinimal) {
+            cout << "Products are shared between expressions, so some are larger than their own minimum" << endl;
+        }
     }
-    StateTransitionTable(vector<string> eninputs, vector<string> enOutputs, vector<State*> enstates) {
+    StateTransitionTable(vector<string> eninputs, vector<string> enOutputs, vector<State*> enstates) : inputSymbols(eninputs) {
         inputs = eninputs;
         outputs = enOutputs;
         states = enstates;
+        coverBudget.maxNodes = 50000;
     }
 
 };
@@ -1016,17 +3292,17 @@ void make_fsm(vector<State*> states, vector<string> inputSignals, vector<string>
         step_reference /= 2;
         value = 0;
     }
-    BubbleDiagram *bd = new BubbleDiagram(states.at(0));
+    BubbleDiagram bd(states.at(0));
     for (int x = 1; x < states.size(); x++) {
-        bd->addState(states.at(x));
-    }
-    bd->formTransitions();
-    StateTransitionTable *stt = new StateTransitionTable(inputSignals, outputSignals, states);
-    stt->getInputData(flipflip_type);
-    stt->getInputExpressions();
-    stt->getOutputData();
-    stt->getOutputExpressions();
-    stt->printSolution(flipflip_type);
+        bd.addState(states.at(x));
+    }
+    bd.formTransitions();
+    StateTransitionTable stt(inputSignals, outputSignals, states);
+    stt.getInputData(flipflip_type);
+    stt.getInputExpressions();
+    stt.getOutputData();
+    stt.getOutputExpressions();
+    stt.printSolution(flipflip_type);
 }
 
 int main() {
@@ -1041,20 +3317,23 @@ int main() {
     //State argument format: (name), (output signals), (destinations), (transition conditions)
     //make_fsm arguments format: (states), (input signals), (output signals), (type of flip flop i.e. D, T, or JK)
     //Related arguments (ex. destinations and transition conditions) must appear in the same order when passed in as vectors
+    //Functions simplified in earlier runs may be kept on disk and reused by opening a cache before calling make_fsm:
+    // ResultCache cache("fsm_cache");
+    // simplifyCache().setDiskCache(&cache);
     //Example: basic up counter 
-    State *a = new State("a", {0, 0, 0}, {"b"}, {"ab"});
-    State *b = new State("b", {0, 0, 1}, {"c"}, {"1"});
-    State *c = new State("c", {0, 1, 0}, {"e"}, {"1"});
-    State *d = new State("d", {0, 1, 1}, {"e"}, {"1"});
-    State *e = new State("e", {1, 0, 0}, {"f"}, {"1"});
-    State *f = new State("f", {1, 0, 1}, {"g"}, {"1"});
-    State *g = new State("g", {1, 1, 0}, {"h"}, {"1"});
-    State *h = new State("h", {1, 1, 1}, {"a"}, {"1"});
-    make_fsm({a, b, c, e, f, g, h}, {}, {"Z2", "Z1", "Z0"}, "D");
+    State a("a", {0, 0, 0}, {"b"}, {"ab"});
+    State b("b", {0, 0, 1}, {"c"}, {"1"});
+    State c("c", {0, 1, 0}, {"e"}, {"1"});
+    State d("d", {0, 1, 1}, {"e"}, {"1"});
+    State e("e", {1, 0, 0}, {"f"}, {"1"});
+    State f("f", {1, 0, 1}, {"g"}, {"1"});
+    State g("g", {1, 1, 0}, {"h"}, {"1"});
+    State h("h", {1, 1, 1}, {"a"}, {"1"});
+    make_fsm({&a, &b, &c, &e, &f, &g, &h}, {}, {"Z2", "Z1", "Z0"}, "D");
 
     //Example: mealy machine
-    // State *x = new State("a", {{0}, {0}}, {"~in", "in"}, {"b"}, {"1"});
-    // State *y = new State("b", {{0}, {0}}, {"~in", "in"}, {"c"}, {"1"});
-    // State *z = new State("c", {{0}, {1}}, {"~in", "in"}, {"a"}, {"1"});
-    // make_fsm({x, y, z}, {"in"}, {"Z0"}, "D");
+    // State x("a", {{0}, {0}}, {"~in", "in"}, {"b"}, {"1"});
+    // State y("b", {{0}, {0}}, {"~in", "in"}, {"c"}, {"1"});
+    // State z("c", {{0}, {1}}, {"~in", "in"}, {"a"}, {"1"});
+    // make_fsm({&x, &y, &z}, {"in"}, {"Z0"}, "D");
 };
\ No newline at end of file
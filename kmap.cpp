@@ -18,392 +18,3573 @@
 
 //And yields ~a~b + c
 
+//Functions too large to list every output may instead be passed in as lists of minterms:
+//(run command) ("sop" or "pos") ("mt" for minterms) (variable list) ("f") (terms whose output is 1) ("d") (terms that are don't care units)
+//A term is either a row number or a cube with one character per variable, 0, 1 or - for both, so 1-0 is rows 4 and 6
+//Example: ./a.exe sop mt a b c f 00- 3 7 d 5 6 solves the same truth table as above
+//If no terms follow "f" they are read from standard input, and --input FILE reads them from a file
+
+//Many functions may be solved in one run by passing "batch", optionally followed by a file, and one function per line on standard input or in the file:
+//(name) (the arguments that would solve the function alone)
+//Example line: f1 sop mt a b c f 00- 3 7 d 5 6
+//Each function prints as "f1: ~a~b + c", in the order they were read, and in batch --threads N solves N functions at once
+
+//Options:
+//--solver kmap (default) grows groups across the kmap, --solver qm finds the prime implicants by the Quine-McCluskey method
+//--solver espresso minimizes heuristically, which is much faster on large functions but may not find the smallest result
+//--max-nodes N and --max-seconds S limit qm's search for the fewest prime implicants, keeping the best cover found when the limit is hit
+//By default qm stops after 50000 search nodes or 2 seconds, and a limit of 0 removes it, so --max-nodes 0 --max-seconds 0 searches until the cover is proven smallest
+//--threads N, from 1 to 1024, finds qm's prime implicants and reduces their cover on N threads, giving the same result for any N
+//--cache DIR keeps solutions in the directory DIR, so solving the same function again, in any later run, skips minimizing it
+//--cache-size MB limits the cache to about MB megabytes, dropping the least recently used solutions (64 by default)
+//--stats prints the time and allocations of each phase of solving, with counts such as groups and prime implicants, as JSON on standard error
+//--delta FILE changes cells of the function after solving it, one line at a time, printing the repaired solution after each line
+//A line such as "on 5 7 off 1-0 dc 3" makes the cells after on 1, after off 0 and after dc don't care, as rows or cubes like those of mt
+//Its words apply from left to right, so a cell named twice takes the later change
+//The solution is repaired around the changed cells rather than found again, so it stays correct but may be larger than solving afresh
+//In batch the phases and counts are summed over every function, and with more than one thread allocations of concurrent functions overlap
+
+//The solvers may be benchmarked by passing "bench", optionally followed by the families to run (random, parity, majority, adder, mux, all by default)
+//Each case prints as a line of JSON with its solve time, time per ON-set minterm, peak RSS, products and literals
+//--vars A-B sets the variable counts, from 1 to 32 (2-12 by default), --seed S, --on P and --dc Q shape the random functions (1, 0.5 and 0.1 by default)
+//--repeat R keeps the fastest of R solves (3 by default), --bench-timeout S stops a case after S seconds (60 by default) and --solver runs one solver instead of all three
+
 #include <string>
 #include <vector>
 #include <iostream>
 #include <math.h>
+#include <memory>
+#include <utility>
+#include <stdexcept>
+#include <cstdint>
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+#include <chrono>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <fstream>
+#include <cstring>
+#include <sstream>
+#include <atomic>
+#include <random>
 using namespace std;
 
 //Program components listed below:
 
-//A name and a sign representing a boolean variable in the input data
-struct BoolVar {
-    string name;
-    bool sign;
-    bool include = true;//Indicates whether this variable is eliminated by the kmap
-    BoolVar(string name, int sign) {
-        this->name = name;
-        this->sign = sign;
+//Boolean expression compiler code below (shared with boolEvaluate.cpp)
+//Parses an expression once into postfix instructions over integer variable slots
+//Grammar: terms separated by '+' are OR'ed, adjacent factors are AND'ed, '~' negates the factor after it
+//Products bind tighter than sums, so "a+bc" is a + (bc)
+enum OpCode {PUSH_VAR, PUSH_CONST, NOT_OP, AND_OP, OR_OP};
+
+struct Instruction {
+    OpCode op;
+    int arg;//Variable slot for PUSH_VAR, constant value for PUSH_CONST
+};
+
+//Four machine words evaluated together, holding 256 input assignments (one per bit)
+//Plain word operations so the compiler can map them onto vector registers
+struct WordBlock {
+    uint64_t w[4];
+    WordBlock operator&(const WordBlock &other) const {
+        return {{w[0] & other.w[0], w[1] & other.w[1], w[2] & other.w[2], w[3] & other.w[3]}};
     }
-    void print() {
-        if (!sign) {
-            cout << "~" << flush;
+    WordBlock operator|(const WordBlock &other) const {
+        return {{w[0] | other.w[0], w[1] | other.w[1], w[2] | other.w[2], w[3] | other.w[3]}};
+    }
+    WordBlock operator~() const {
+        return {{~w[0], ~w[1], ~w[2], ~w[3]}};
+    }
+};
+
+struct CompiledExpression {
+    vector<Instruction> code;
+    vector<int> stack;//Sized at compile time to the deepest point of the expression so eval never allocates
+    int varCount = 0;
+
+    //Evaluates the expression for one input assignment, inputVals is indexed by variable slot
+    int eval(const vector<int> &inputVals) {
+        int top = -1;
+        for (const Instruction &instruction : code) {
+            switch (instruction.op) {
+                case PUSH_VAR:
+                    stack[++top] = (inputVals[instruction.arg] != 0);
+                    break;
+                case PUSH_CONST:
+                    stack[++top] = instruction.arg;
+                    break;
+                case NOT_OP:
+                    stack[top] = !stack[top];
+                    break;
+                case AND_OP:
+                    top--;
+                    stack[top] = stack[top] & stack[top + 1];
+                    break;
+                case OR_OP:
+                    top--;
+                    stack[top] = stack[top] | stack[top + 1];
+                    break;
+            }
         }
-        cout << name << flush;
+        return stack[0];
+    }
+
+    //Evaluates the expression for a whole lane of assignments at once, bit i of every input lane belongs to assignment i
+    //laneStack must hold at least stack.size() entries
+    template <class Word>
+    Word evalLanes(const Word *inputLanes, Word *laneStack) const {
+        int top = -1;
+        for (const Instruction &instruction : code) {
+            switch (instruction.op) {
+                case PUSH_VAR:
+                    laneStack[++top] = inputLanes[instruction.arg];
+                    break;
+                case PUSH_CONST:
+                    laneStack[++top] = instruction.arg ? ~Word{} : Word{};
+                    break;
+                case NOT_OP:
+                    laneStack[top] = ~laneStack[top];
+                    break;
+                case AND_OP:
+                    top--;
+                    laneStack[top] = laneStack[top] & laneStack[top + 1];
+                    break;
+                case OR_OP:
+                    top--;
+                    laneStack[top] = laneStack[top] | laneStack[top + 1];
+                    break;
+            }
+        }
+        return laneStack[0];
     }
 };
 
-//A single cell in the kmap
-struct Cell {
-    //Cell pointers are used to represent adjacencies
-    //A vector must be used to allow for an unknown number of variables
-    string name;
-    int value;
-    Cell *next;
-    int groupsIn = 0;
-    vector<Cell*> adjacencies;
-    vector<BoolVar*> boolVars;
-    Cell(int value) {
-        this->value = value;
+//Variable names interned into dense ids, where id x is the name at index x of the list it was built from
+//Names are stored in a trie, so the longest name starting at any position is found in one pass over its characters
+class SymbolTable {
+    struct Node {
+        vector<pair<char, int>> children;//Next character and the index of its node
+        int id = -1;//Id of the name ending at this node
+    };
+    vector<Node> nodes;
+    int findChild(int node, char c) const {
+        for (const pair<char, int> &child : nodes[node].children) {
+            if (child.first == c) {
+                return child.second;
+            }
+        }
+        return -1;
     }
-    void add(Cell *cell) {
-        adjacencies.push_back(cell);
+
+    public:
+    SymbolTable(const vector<string> &names) {
+        nodes.emplace_back();
+        for (int x = 0; x < names.size(); x++) {
+            int node = 0;
+            for (char c : names.at(x)) {
+                int next = findChild(node, c);
+                if (next < 0) {
+                    next = nodes.size();
+                    nodes[node].children.push_back({c, next});
+                    nodes.emplace_back();
+                }
+                node = next;
+            }
+            //The first of any repeated names keeps the id, and an empty name is never matched
+            if (node != 0 && nodes[node].id < 0) {
+                nodes[node].id = x;
+            }
+        }
     }
-    void addVar(BoolVar *boolVar) {
-        boolVars.push_back(boolVar);
+    //Returns the id of the longest name starting at pos in text and sets length to its size, or -1 if none starts there
+    int match(const string &text, int pos, int &length) const {
+        int best = -1;
+        length = 0;
+        int node = 0;
+        for (int x = pos; x < text.size(); x++) {
+            node = findChild(node, text[x]);
+            if (node < 0) {
+                break;
+            }
+            if (nodes[node].id >= 0) {
+                best = nodes[node].id;
+                length = x - pos + 1;
+            }
+        }
+        return best;
     }
 };
-struct Group {
-    string expression;//Boolean expression required to represent the group
-    bool necessary = false;
-    vector<Cell*> elements;
-    void Add(Cell *element) {
-        elements.push_back(element);
+
+class ExpressionCompiler {
+    string expression;
+    SymbolTable symbols;
+    int varCount;
+    int pos = 0;
+    CompiledExpression *result;
+
+    char peek() {
+        return pos < expression.size() ? expression.at(pos) : '\0';
     }
-    Group(Cell *cell) {
-        Add(cell);
+    void emit(OpCode op, int arg) {
+        result->code.push_back({op, arg});
     }
-    Group() {
-        
+    //Finds the longest input name starting at the current position, so names sharing a prefix are not ambiguous
+    int matchVariable() {
+        int length;
+        int slot = symbols.match(expression, pos, length);
+        pos += length;
+        return slot;
     }
-    
-    //For debugging purposes
-    void Print() {
-        int size = elements.size();
-        for (int x = 0; x < size; x++) {
-            cout << elements.at(x)->name << " " << flush;
+    //A parenthesis level saved while the expression inside it is parsed
+    struct ParseLevel {
+        int negations;//Number of '~' before the '(', applied when it closes
+        bool hasFactor;//Whether the enclosing product already had a factor before the '('
+        bool hasProduct;//Whether the enclosing sum already had a finished product before the '('
+    };
+    //Parses the whole expression in one loop, each '(' saving the enclosing product and sum on an explicit stack as ParenFrame does,
+    //so deeply nested expressions never recurse and only the stack of levels grows
+    void parseSum() {
+        vector<ParseLevel> levels;
+        bool hasFactor = false;
+        bool hasProduct = false;
+        while (true) {
+            int negations = 0;
+            while (peek() == '~') {
+                pos++;
+                negations++;
+            }
+            if (peek() == '(') {
+                pos++;
+                levels.push_back({negations, hasFactor, hasProduct});
+                hasFactor = false;
+                hasProduct = false;
+                continue;
+            }
+            int slot = matchVariable();
+            if (slot >= 0) {
+                emit(PUSH_VAR, slot);
+            }
+            else if (peek() == '0' || peek() == '1') {
+                emit(PUSH_CONST, peek() - '0');
+                pos++;
+            }
+            else {
+                throw invalid_argument("Unexpected '" + string(1, peek()) + "' at position " + to_string(pos) + " in expression: " + expression);
+            }
+            for (int x = 0; x < negations; x++) {
+                emit(NOT_OP, 0);
+            }
+            //The factor is finished, along with every product, sum and parenthesis it ends
+            while (true) {
+                if (hasFactor) {
+                    emit(AND_OP, 0);
+                }
+                hasFactor = true;
+                if (pos < expression.size() && peek() != '+' && peek() != ')') {
+                    break;
+                }
+                if (hasProduct) {
+                    emit(OR_OP, 0);
+                }
+                hasProduct = true;
+                hasFactor = false;
+                if (peek() == '+') {
+                    pos++;
+                    break;
+                }
+                if (levels.empty()) {
+                    return;
+                }
+                if (peek() != ')') {
+                    throw invalid_argument("Missing ')' in expression: " + expression);
+                }
+                pos++;
+                ParseLevel level = levels.back();
+                levels.pop_back();
+                for (int x = 0; x < level.negations; x++) {
+                    emit(NOT_OP, 0);
+                }
+                hasFactor = level.hasFactor;
+                hasProduct = level.hasProduct;
+            }
         }
-        cout << endl;
     }
-};
 
-//A single column in a truth table
-struct TruthColumn {
-    //A variable name and a vector of bools representing each case
-    string name;
-    vector<int> values;
-    TruthColumn(string name) {
-        this->name = name;
+    public:
+    ExpressionCompiler(string expression, vector<string> inputNames) : symbols(inputNames) {
+        //Eliminate whitespace
+        for (char c : expression) {
+            if (c != ' ') {
+                this->expression += c;
+            }
+        }
+        varCount = inputNames.size();
     }
-    //Adds a value to the column
-    void addValue(int value) {
-        values.push_back(value);
+    void compile(CompiledExpression *compiled) {
+        result = compiled;
+        result->varCount = varCount;
+        parseSum();
+        if (pos != expression.size()) {
+            throw invalid_argument("Unmatched ')' in expression: " + expression);
+        }
+        //Size the evaluation stack to the deepest point reached by the instructions
+        int depth = 0;
+        int maxDepth = 0;
+        for (const Instruction &instruction : result->code) {
+            if (instruction.op == PUSH_VAR || instruction.op == PUSH_CONST) {
+                depth++;
+            }
+            else if (instruction.op != NOT_OP) {
+                depth--;
+            }
+            maxDepth = max(maxDepth, depth);
+        }
+        result->stack.assign(maxDepth, 0);
     }
 };
 
-//Truth columns organized into a truth table
-class TruthTable {
-    //A vector of truth column inputs and a single output truth column
-    public:
-    vector<TruthColumn*> inputs;
-    TruthColumn *output;
-    //Constructor to build truth table out of a string representing a boolean function
-    TruthTable(string expression) {
+//Lists the variables of an expression given without a variable list, in alphabetical order
+//A variable is a letter followed by any digits (e.g. a, b, Q1), so "ab" is a AND b
+vector<string> findVariables(string expression) {
+    vector<string> names;
+    for (int x = 0; x < expression.size(); x++) {
+        if (isalpha(expression.at(x))) {
+            string name(1, expression.at(x));
+            while (x + 1 < expression.size() && isdigit(expression.at(x + 1))) {
+                name += expression.at(++x);
+            }
+            if (find(names.begin(), names.end(), name) == names.end()) {
+                names.push_back(name);
+            }
+        }
+    }
+    sort(names.begin(), names.end());
+    return names;
+}
 
+CompiledExpression compileExpression(string expression, vector<string> inputNames) {
+    CompiledExpression compiled;
+    ExpressionCompiler(expression, inputNames).compile(&compiled);
+    return compiled;
+}
+
+//Bit patterns of the six lowest row-index bits within one 64-row word
+const uint64_t LOW_ROW_PATTERNS[6] = {
+    0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+    0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull
+};
+
+//Value of input variable var for the 64 rows stored in word wordIndex
+//Rows are in ascending binary order with the first variable as the most significant bit
+uint64_t inputWord(int var, int varCount, uint64_t wordIndex) {
+    int bit = varCount - 1 - var;
+    if (bit < 6) {
+        return LOW_ROW_PATTERNS[bit];
     }
-    //Constructor to automatically generate input values, assumes output is in binary ascending order
-    TruthTable(vector<string> inputNames, string outputName, vector<int> outputs) {
-        TruthColumn *newTruthColumn;
-        for (string name : inputNames) {
-            inputs.push_back(new TruthColumn(name));
-        }
-        output = new TruthColumn(outputName);
-        output->values = outputs;
+    return ((wordIndex >> (bit - 6)) & 1) ? ~0ull : 0ull;
+}
 
-        //Add input values in ascending binary order
-        int size = pow(2, inputs.size());
-        int inputNum = inputs.size();
-        int step = size;
-        bool value = true;
-        for (int x = 0; x < inputNum; x++) {
-            step /= 2;
-            for (int y = 0; y < size; y++) {
-                if (y % step == 0) {
-                    value = !value;
+//Evaluates a compiled expression over all 2^n input assignments
+//Returns the output column packed 64 rows per word, row r is bit (r % 64) of word (r / 64)
+vector<uint64_t> packedTruthTable(const CompiledExpression &compiled) {
+    int varCount = compiled.varCount;
+    uint64_t rowCount = 1ull << varCount;
+    uint64_t wordCount = (rowCount + 63) / 64;
+    vector<uint64_t> table(wordCount);
+    int stackSize = max((int) compiled.stack.size(), 1);
+    uint64_t word = 0;
+    if (wordCount >= 4) {
+        vector<WordBlock> inputLanes(varCount);
+        vector<WordBlock> laneStack(stackSize);
+        for (; word < wordCount; word += 4) {
+            for (int x = 0; x < varCount; x++) {
+                for (int y = 0; y < 4; y++) {
+                    inputLanes[x].w[y] = inputWord(x, varCount, word + y);
                 }
-                inputs.at(x)->addValue(value);
+            }
+            WordBlock result = compiled.evalLanes(inputLanes.data(), laneStack.data());
+            for (int y = 0; y < 4; y++) {
+                table[word + y] = result.w[y];
             }
         }
     }
-    //Returns value of output at an entered index
-    int outputAt(int index) {
-        return output->values.at(index);
+    else {
+        vector<uint64_t> inputLanes(varCount);
+        vector<uint64_t> laneStack(stackSize);
+        for (; word < wordCount; word++) {
+            for (int x = 0; x < varCount; x++) {
+                inputLanes[x] = inputWord(x, varCount, word);
+            }
+            table[word] = compiled.evalLanes(inputLanes.data(), laneStack.data());
+        }
+    }
+    //Clear the unused bits of a table with fewer than 64 rows
+    if (rowCount < 64) {
+        table[0] &= (1ull << rowCount) - 1;
+    }
+    return table;
+}
+//Boolean expression compiler code above
+
+//Packed truth table kernels below
+//Kernels work on tables packed 64 rows per word in the layout produced by packedTruthTable
+//Each kernel has a portable version and, on x86 with GCC or Clang, an AVX2 version picked at run time
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAS_AVX2_KERNELS
+#endif
+
+int popcount64(uint64_t word) {
+#ifdef __GNUC__
+    return __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (word * 0x0101010101010101ull) >> 56;
+#endif
+}
+
+//Mask of the rows actually present in the last word of a table with varCount variables
+uint64_t lastWordMask(int varCount) {
+    return varCount >= 6 ? ~0ull : (1ull << (1 << varCount)) - 1;
+}
+
+//Writes the value of input variable var for every row, i.e. the packed input column of the truth table
+void fillInputColumnPortable(uint64_t *column, int var, int varCount, uint64_t wordCount) {
+    int bit = varCount - 1 - var;
+    if (bit < 6) {
+        fill(column, column + wordCount, LOW_ROW_PATTERNS[bit]);
+    }
+    else {
+        //Variable is constant across runs of whole words that alternate between all 0's and all 1's
+        uint64_t run = 1ull << (bit - 6);
+        for (uint64_t word = 0; word < wordCount; word += run) {
+            fill(column + word, column + word + run, ((word / run) & 1) ? ~0ull : 0ull);
+        }
+    }
+    column[wordCount - 1] &= lastWordMask(varCount);
+}
+
+//Number of 1's in the table
+uint64_t countOnesPortable(const uint64_t *table, uint64_t wordCount) {
+    uint64_t count = 0;
+    for (uint64_t word = 0; word < wordCount; word++) {
+        count += popcount64(table[word]);
+    }
+    return count;
+}
+
+#ifdef HAS_AVX2_KERNELS
+__attribute__((target("avx2")))
+void fillInputColumnAVX2(uint64_t *column, int var, int varCount, uint64_t wordCount) {
+    int bit = varCount - 1 - var;
+    if (wordCount < 4) {
+        fillInputColumnPortable(column, var, varCount, wordCount);
+        return;
+    }
+    //Tables of 4 or more words have a multiple of 4 words, so every store is a full vector
+    if (bit < 6) {
+        __m256i pattern = _mm256_set1_epi64x(LOW_ROW_PATTERNS[bit]);
+        for (uint64_t word = 0; word < wordCount; word += 4) {
+            _mm256_storeu_si256((__m256i *) (column + word), pattern);
+        }
+        return;
+    }
+    uint64_t run = 1ull << (bit - 6);
+    __m256i ones = _mm256_set1_epi64x(-1);
+    __m256i zeros = _mm256_setzero_si256();
+    if (run < 4) {
+        //Runs shorter than a vector repeat with a period of 2 * run words
+        uint64_t block[4];
+        for (int y = 0; y < 4; y++) {
+            block[y] = ((y / run) & 1) ? ~0ull : 0ull;
+        }
+        __m256i pattern = _mm256_loadu_si256((const __m256i *) block);
+        for (uint64_t word = 0; word < wordCount; word += 4) {
+            _mm256_storeu_si256((__m256i *) (column + word), pattern);
+        }
+        return;
+    }
+    for (uint64_t word = 0; word < wordCount; word += run) {
+        __m256i value = ((word / run) & 1) ? ones : zeros;
+        for (uint64_t y = 0; y < run; y += 4) {
+            _mm256_storeu_si256((__m256i *) (column + word + y), value);
+        }
+    }
+}
+
+//Counts bits a nibble at a time with a shuffle lookup, then sums the bytes of each word
+__attribute__((target("avx2")))
+uint64_t countOnesAVX2(const uint64_t *table, uint64_t wordCount) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibble = _mm256_set1_epi8(0x0F);
+    __m256i total = _mm256_setzero_si256();
+    uint64_t word = 0;
+    for (; word + 4 <= wordCount; word += 4) {
+        __m256i block = _mm256_loadu_si256((const __m256i *) (table + word));
+        __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(block, lowNibble));
+        __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(block, 4), lowNibble));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
     }
+    uint64_t sums[4];
+    _mm256_storeu_si256((__m256i *) sums, total);
+    return sums[0] + sums[1] + sums[2] + sums[3] + countOnesPortable(table + word, wordCount - word);
+}
+#endif
+
+//Kernel set chosen once, on first use, according to what the running processor supports
+struct TableKernels {
+    void (*fillInputColumn)(uint64_t *column, int var, int varCount, uint64_t wordCount);
+    uint64_t (*countOnes)(const uint64_t *table, uint64_t wordCount);
 };
 
-class KarnaughMap {
-    Cell *first;//First cell in linked list of all cells in kmap
-    vector<Cell*> cells;//Vector of all cells in kmap for easier access
-    vector<Group*> groups;//Groups formed in kmap
-    string solution = "";
-    int method;
-    public:
+TableKernels chooseTableKernels() {
+#ifdef HAS_AVX2_KERNELS
+    if (__builtin_cpu_supports("avx2")) {
+        return {fillInputColumnAVX2, countOnesAVX2};
+    }
+#endif
+    return {fillInputColumnPortable, countOnesPortable};
+}
 
-    //Method to make list of cells
-    void makeCellList(TruthTable* truthTable) {
-        first = new Cell(truthTable->outputAt(0));
-        cells.push_back(first);
-        int cellCount = pow(2, truthTable->inputs.size());
-        for (int x = 1; x < cellCount; x++) {
-            first->next = new Cell(truthTable->outputAt(x));
-            first = first->next;
-            cells.push_back(first);
-        }
-        first = cells.at(0);
-    }
-
-    //Adds boolean variables to each cell
-    void addBools(TruthTable *truthTable) {
-        bool varSign;
-        string varName;
-        Cell *curr = first;
-        int cellCount = cells.size();
-        int varCount = truthTable->inputs.size();
-        for (int x = 0; x < cellCount; x++) {
-            for (int y = 0; y < varCount; y++) {
-                varSign = (bool) truthTable->inputs.at(y)->values.at(x);
-                varName = truthTable->inputs.at(y)->name;
-                curr->addVar(new BoolVar(varName, varSign));
+const TableKernels &tableKernels() {
+    static const TableKernels kernels = chooseTableKernels();
+    return kernels;
+}
+
+//Packed input column of variable var in a table with varCount variables
+vector<uint64_t> packedInputColumn(int var, int varCount) {
+    uint64_t wordCount = ((1ull << varCount) + 63) / 64;
+    vector<uint64_t> column(wordCount);
+    tableKernels().fillInputColumn(column.data(), var, varCount, wordCount);
+    return column;
+}
+
+//Number of rows set in a packed table
+uint64_t countOnes(const vector<uint64_t> &table) {
+    return tableKernels().countOnes(table.data(), table.size());
+}
+//Packed truth table kernels above
+
+//Binary decision diagram code below
+//Reduced ordered BDDs give every function one canonical form, so equal functions have equal edges
+//Variables are ordered by index, variable 0 at the top, matching the row order of truth tables and expression slots
+//An edge is a node index shifted left once, with the low bit set when it complements the function below it
+//Node 0 is the constant 1, so edge 0 is true and edge 1 is false
+typedef uint32_t BddEdge;
+const BddEdge BDD_TRUE = 0;
+const BddEdge BDD_FALSE = 1;
+const uint32_t BDD_NO_NODE = 0xFFFFFFFF;//End of a unique table chain or free list
+const size_t MAX_BDD_CACHE = 1 << 22;//Computed table entries
+
+class BddManager {
+    struct Node {
+        int var;
+        BddEdge low;//Function when var is 0, may be complemented
+        BddEdge high;//Function when var is 1, never complemented so each function has one form
+        uint32_t next;//Next node in the same unique table bucket
+        uint32_t refs;//External references held through protect()
+    };
+    //Remembered result of an operation on two edges
+    struct CacheEntry {
+        BddEdge f;
+        BddEdge g;
+        BddEdge result;
+        int op = -1;
+    };
+    enum BddOp {AND_BDD_OP};
+
+    vector<Node> nodes;
+    vector<uint32_t> buckets;//Unique table, first node index of each bucket chain
+    vector<CacheEntry> cache;//Computed table, direct mapped
+    uint32_t freeList = BDD_NO_NODE;//Nodes reclaimed by garbage collection, chained through next
+    uint32_t liveNodes = 1;
+    uint32_t collectAt = 1 << 16;//Live node count that triggers the next garbage collection
+
+    static uint32_t hashTriple(uint32_t a, uint32_t b, uint32_t c) {
+        uint64_t h = a * 0x9E3779B97F4A7C15ull;
+        h ^= (b + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2));
+        h ^= (c + 0x85EBCA77C2B2AE63ull + (h << 6) + (h >> 2));
+        return (uint32_t) (h ^ (h >> 29));
+    }
+    static uint32_t nodeOf(BddEdge e) {
+        return e >> 1;
+    }
+    int topVar(BddEdge e) const {
+        return nodeOf(e) == 0 ? INT32_MAX : nodes[nodeOf(e)].var;
+    }
+    //Low and high cofactors of e with respect to var, e must not depend on any variable above var
+    void cofactors(BddEdge e, int var, BddEdge &low, BddEdge &high) const {
+        if (topVar(e) != var) {
+            low = e;
+            high = e;
+            return;
+        }
+        const Node &node = nodes[nodeOf(e)];
+        low = node.low ^ (e & 1);
+        high = node.high ^ (e & 1);
+    }
+    //Doubles the unique table, and the computed table with it until it reaches MAX_BDD_CACHE entries
+    void growBuckets() {
+        buckets.assign(buckets.size() * 2, BDD_NO_NODE);
+        rehash();
+        if (cache.size() < buckets.size() && cache.size() < MAX_BDD_CACHE) {
+            //Entries are placed by hash, so the larger table starts empty
+            cache.assign(cache.size() * 2, CacheEntry());
+        }
+    }
+    void rehash() {
+        fill(buckets.begin(), buckets.end(), BDD_NO_NODE);
+        for (uint32_t x = 1; x < nodes.size(); x++) {
+            if (nodes[x].var >= 0) {
+                uint32_t bucket = hashTriple(nodes[x].var, nodes[x].low, nodes[x].high) & (buckets.size() - 1);
+                nodes[x].next = buckets[bucket];
+                buckets[bucket] = x;
             }
-            curr = curr->next;
         }
     }
-
-    //Rearranges according to kmap convention (i.e. swaps third and fourth row in each dimension)
-    void rearrange() {
-        vector<Cell*> bench;
-        int cellCount = cells.size();
-        int rearrangements = log10(cellCount) / log10(4);
-        int interval;
-        for (int x = 0; x < rearrangements; x++) {
-            interval = 2 * int(pow(4, x));
-            for (int y = 0; y < cellCount;) {
-                y += interval;
-                if (y >= cellCount) {break;}
-                for (int z = 0; z < interval; z++) {
-                    bench.push_back(cells.at(y + z));
-                }
-                for (int a = 0; a < interval / 2; a++) {
-                    cells.at(y + a) = bench.at((interval / 2) + a);
-                }
-                for (int b = interval / 2; b < interval; b++) {
-                    cells.at(y + b) = bench.at(b - (interval / 2));
-                }
-                bench.clear();
-                y += interval;
+    BddEdge andRec(BddEdge f, BddEdge g) {
+        if (f == BDD_FALSE || g == BDD_FALSE || f == (g ^ 1)) {
+            return BDD_FALSE;
+        }
+        if (f == BDD_TRUE || f == g) {
+            return g;
+        }
+        if (g == BDD_TRUE) {
+            return f;
+        }
+        if (f > g) {
+            swap(f, g);
+        }
+        CacheEntry &entry = cache[hashTriple(AND_BDD_OP, f, g) & (cache.size() - 1)];
+        if (entry.op == AND_BDD_OP && entry.f == f && entry.g == g) {
+            return entry.result;
+        }
+        int var = min(topVar(f), topVar(g));
+        BddEdge fLow, fHigh, gLow, gHigh;
+        cofactors(f, var, fLow, fHigh);
+        cofactors(g, var, gLow, gHigh);
+        BddEdge low = andRec(fLow, gLow);
+        BddEdge high = andRec(fHigh, gHigh);
+        BddEdge result = makeNode(var, low, high);
+        //Recursion may have replaced the entry, so look it up again
+        CacheEntry &slot = cache[hashTriple(AND_BDD_OP, f, g) & (cache.size() - 1)];
+        slot.f = f;
+        slot.g = g;
+        slot.result = result;
+        slot.op = AND_BDD_OP;
+        return result;
+    }
+    void mark(BddEdge e, vector<char> &marked) {
+        vector<uint32_t> pending = {nodeOf(e)};
+        while (!pending.empty()) {
+            uint32_t node = pending.back();
+            pending.pop_back();
+            if (node == 0 || marked[node]) {
+                continue;
             }
+            marked[node] = 1;
+            pending.push_back(nodeOf(nodes[node].low));
+            pending.push_back(nodeOf(nodes[node].high));
+        }
+    }
+    //Collects garbage once the diagram has grown past the threshold, keeping the operands of the caller
+    void maybeCollect(BddEdge f, BddEdge g) {
+        if (liveNodes < collectAt) {
+            return;
+        }
+        collectGarbage({f, g});
+        //Grow the threshold when most nodes survive so collection stays rare
+        if (liveNodes > collectAt / 2) {
+            collectAt *= 2;
         }
     }
 
-    //Forms adjacencies
-    void formAdjacendies(TruthTable *truthTable) {
-        vector<Cell*> cellsInverted;
-        int cellCount = cells.size();
-        int varCount = truthTable->inputs.size();
-        for (int x = 0; x < cellCount; x++) {
-            cellsInverted.push_back(cells.at(cellCount - 1 - x));
+    public:
+    BddManager() {
+        nodes.push_back({-1, BDD_TRUE, BDD_TRUE, BDD_NO_NODE, 1});
+        buckets.assign(1 << 12, BDD_NO_NODE);
+        cache.resize(1 << 16);
+    }
+
+    //Returns the node for var ? high : low, reusing an existing node when there is one
+    BddEdge makeNode(int var, BddEdge low, BddEdge high) {
+        if (low == high) {
+            return low;
+        }
+        //Keep the high edge regular by moving a complement up onto the returned edge
+        if (high & 1) {
+            return makeNode(var, low ^ 1, high ^ 1) ^ 1;
+        }
+        uint32_t bucket = hashTriple(var, low, high) & (buckets.size() - 1);
+        for (uint32_t x = buckets[bucket]; x != BDD_NO_NODE; x = nodes[x].next) {
+            if (nodes[x].var == var && nodes[x].low == low && nodes[x].high == high) {
+                return x << 1;
+            }
+        }
+        uint32_t index;
+        if (freeList != BDD_NO_NODE) {
+            index = freeList;
+            freeList = nodes[index].next;
+            nodes[index] = {var, low, high, buckets[bucket], 0};
+        }
+        else {
+            index = nodes.size();
+            nodes.push_back({var, low, high, buckets[bucket], 0});
+        }
+        buckets[bucket] = index;
+        liveNodes++;
+        if (liveNodes > buckets.size()) {
+            growBuckets();
         }
-        int interval;
-        int step;
-        int dimCount = ((varCount + 1) / 2);\
-        for (int x = 0; x < dimCount; x++) {
-        step = 0;
-        for (int y = 0; y < cellCount; ) {
-            for (int z = 0; z < pow(4, x); z++) {
-                cells.at(y)->add(cells.at((step + ((int(y + pow(4, x))) % int (pow(4, x + 1)))) % cellCount));
-                y++;
+        return index << 1;
+    }
+
+    BddEdge variable(int var) {
+        return makeNode(var, BDD_FALSE, BDD_TRUE);
+    }
+    BddEdge bddNot(BddEdge f) {
+        return f ^ 1;
+    }
+    BddEdge bddAnd(BddEdge f, BddEdge g) {
+        maybeCollect(f, g);
+        return andRec(f, g);
+    }
+    BddEdge bddOr(BddEdge f, BddEdge g) {
+        maybeCollect(f, g);
+        return andRec(f ^ 1, g ^ 1) ^ 1;
+    }
+
+    //Edges held outside an operation must be protected or the garbage collector may reclaim them
+    void protect(BddEdge f) {
+        nodes[nodeOf(f)].refs++;
+    }
+    void release(BddEdge f) {
+        nodes[nodeOf(f)].refs--;
+    }
+    //Reclaims every node not reachable from a protected edge or from roots
+    void collectGarbage(const vector<BddEdge> &roots) {
+        vector<char> marked(nodes.size(), 0);
+        for (uint32_t x = 1; x < nodes.size(); x++) {
+            if (nodes[x].var >= 0 && nodes[x].refs > 0) {
+                mark(x << 1, marked);
             }
-            if (int((y) % (int(pow(4, x + 1)))) == 0) {
-                step += pow(4, x + 1);
+        }
+        for (BddEdge root : roots) {
+            mark(root, marked);
+        }
+        for (uint32_t x = 1; x < nodes.size(); x++) {
+            if (nodes[x].var >= 0 && !marked[x]) {
+                nodes[x].var = -1;
+                nodes[x].next = freeList;
+                freeList = x;
+                liveNodes--;
             }
         }
-        step = 0;
-        for (int y = 0; y < cellCount;) {
-            for (int z = 0; z < pow(4, x); z++) {
-                cellsInverted.at(y)->add(cellsInverted.at((step + ((int(y + pow(4, x))) % int (pow(4, x + 1)))) % cellCount));
-                y++;
+        rehash();
+        for (CacheEntry &entry : cache) {
+            entry.op = -1;
+        }
+    }
+
+    //Two functions are equal exactly when their edges are equal
+    bool equivalent(BddEdge f, BddEdge g) const {
+        return f == g;
+    }
+    bool satisfiable(BddEdge f) const {
+        return f != BDD_FALSE;
+    }
+    //One input assignment making f true, indexed by variable, or an empty vector if there is none
+    vector<int> satisfyingAssignment(BddEdge f, int varCount) const {
+        if (f == BDD_FALSE) {
+            return {};
+        }
+        vector<int> values(varCount, 0);
+        while (nodeOf(f) != 0) {
+            const Node &node = nodes[nodeOf(f)];
+            BddEdge low = node.low ^ (f & 1);
+            if (low != BDD_FALSE) {
+                f = low;
             }
-            if (int((y) % (int(pow(4, x + 1)))) == 0) {
-                step += pow(4, x + 1);
+            else {
+                values[node.var] = 1;
+                f = node.high ^ (f & 1);
             }
         }
+        return values;
     }
+    //Number of assignments of varCount variables (fewer than 64) making f true, in time linear in the size of f
+    uint64_t countMinterms(BddEdge f, int varCount) const {
+        if (varCount >= 64) {
+            throw invalid_argument("Minterm counts are limited to 63 variables");
+        }
+        vector<uint64_t> counts(nodes.size(), UINT64_MAX);//Minterms of each regular node over variables from its own down
+        return countBelow(f, 0, varCount, counts);
     }
-
-    //Names each cell according to the minterm/maxterm number it represents
-    void nameCells() {
-        int cellCount = cells.size();
-        for(int x = 0; x < cellCount; x++) {
-            cells.at(x)->name = to_string(x);
+    uint64_t countBelow(BddEdge f, int level, int varCount, vector<uint64_t> &counts) const {
+        uint32_t index = nodeOf(f);
+        uint64_t total = 1ull << (varCount - level);
+        if (index == 0) {
+            return (f & 1) ? 0 : total;
         }
+        const Node &node = nodes[index];
+        if (counts[index] == UINT64_MAX) {
+            counts[index] = countBelow(node.low, node.var + 1, varCount, counts) + countBelow(node.high, node.var + 1, varCount, counts);
+        }
+        uint64_t count = counts[index] << (node.var - level);
+        return (f & 1) ? total - count : count;
+    }
+    //Number of distinct nodes reachable from f, not counting the constant
+    uint32_t size(BddEdge f) {
+        vector<char> marked(nodes.size(), 0);
+        mark(f, marked);
+        uint32_t count = 0;
+        for (char m : marked) {
+            count += m;
+        }
+        return count;
+    }
+    uint32_t nodeCount() const {
+        return liveNodes;
     }
+};
 
-    //For debugging purposes
-    void print() {
-        for (int x = 0; x < cells.size(); x++) {
-            cout << cells.at(x)->name << " = " << cells.at(x)->value << " -> " << flush;
-            for (int y = 0; y < cells.at(x)->adjacencies.size(); y++) {
-                cout << cells.at(x)->adjacencies.at(y)->name << " = " << cells.at(x)->adjacencies.at(y)->value << " -> " << flush;
+//Builds the BDD of a compiled expression, variable x of the diagram is expression slot x
+BddEdge bddFromExpression(BddManager &manager, const CompiledExpression &compiled) {
+    vector<BddEdge> stack;
+    for (const Instruction &instruction : compiled.code) {
+        BddEdge result = BDD_FALSE;
+        switch (instruction.op) {
+            case PUSH_VAR:
+                result = manager.variable(instruction.arg);
+                break;
+            case PUSH_CONST:
+                result = instruction.arg ? BDD_TRUE : BDD_FALSE;
+                break;
+            case NOT_OP:
+                result = manager.bddNot(stack.back());
+                manager.release(stack.back());
+                stack.pop_back();
+                break;
+            case AND_OP:
+            case OR_OP: {
+                BddEdge g = stack.back();
+                stack.pop_back();
+                BddEdge f = stack.back();
+                stack.pop_back();
+                result = instruction.op == AND_OP ? manager.bddAnd(f, g) : manager.bddOr(f, g);
+                manager.release(f);
+                manager.release(g);
+                break;
             }
-            cout << endl;
         }
+        //Operands waiting on the stack are protected so collection during later operations keeps them
+        manager.protect(result);
+        stack.push_back(result);
     }
-        KarnaughMap(TruthTable* truthTable, int method) {
-            this->method = method;//Indicates whether to group 1's (SOP) or 0's (POS)
-            makeCellList(truthTable);//Forms list of cells
-            nameCells();//Names cells in minterm/maxterm order (i.e. 0, 1, 2...etc)
-            addBools(truthTable);//Adds boolean variable representation to each cell in the kmap
-            rearrange();//Rearranges cell order in kmap convention
-            formAdjacendies(truthTable);//Forms appropriate adjacencies between cells
+    manager.release(stack.back());
+    return stack.back();
+}
+
+//Builds the BDD of rows firstRow to firstRow + 2^(varCount - var) - 1 of a packed table
+BddEdge bddFromRows(BddManager &manager, const vector<uint64_t> &table, int var, int varCount, uint64_t firstRow) {
+    int rowBits = varCount - var;
+    if (rowBits <= 6) {
+        uint64_t mask = rowBits == 6 ? ~0ull : (1ull << (1 << rowBits)) - 1;
+        uint64_t rows = (table[firstRow / 64] >> (firstRow % 64)) & mask;
+        if (rows == 0) {
+            return BDD_FALSE;
+        }
+        if (rows == mask) {
+            return BDD_TRUE;
         }
+    }
+    else {
+        //Whole words that are all 0's or all 1's are constant without descending further
+        uint64_t firstWord = firstRow / 64;
+        uint64_t wordCount = 1ull << (rowBits - 6);
+        bool allZero = true;
+        bool allOne = true;
+        for (uint64_t x = firstWord; x < firstWord + wordCount && (allZero || allOne); x++) {
+            allZero = allZero && table[x] == 0;
+            allOne = allOne && table[x] == ~0ull;
+        }
+        if (allZero) {
+            return BDD_FALSE;
+        }
+        if (allOne) {
+            return BDD_TRUE;
+        }
+    }
+    uint64_t half = 1ull << (rowBits - 1);
+    BddEdge low = bddFromRows(manager, table, var + 1, varCount, firstRow);
+    manager.protect(low);
+    BddEdge high = bddFromRows(manager, table, var + 1, varCount, firstRow + half);
+    manager.release(low);
+    return manager.makeNode(var, low, high);
+}
 
-        //For debugging purposes
-        void printGroups(vector<Group*> groupsToPrint) {
-            for (int x = 0; x < groupsToPrint.size(); x++) {
-                groupsToPrint.at(x)->Print();
-            }
+//Builds the BDD of a table packed in the layout produced by packedTruthTable
+BddEdge bddFromPackedTable(BddManager &manager, const vector<uint64_t> &table, int varCount) {
+    return bddFromRows(manager, table, 0, varCount, 0);
+}
+//Binary decision diagram code above
+
+//Shannon expansion truth table code below
+//The expression is held as a graph of unique nodes, so equal subexpressions, and equal cofactors, are the same node
+//Node 0 is the constant 0 and node 1 the constant 1
+struct ExprNode {
+    OpCode op;//PUSH_VAR, PUSH_CONST, NOT_OP, AND_OP or OR_OP
+    int a;//Variable slot, constant value, or first operand
+    int b;//Second operand of AND_OP and OR_OP
+};
+
+class ExpressionGraph {
+    unordered_map<uint64_t, int> unique;//Packed (op, a, b) of every node to its index
+
+    int find(OpCode op, int a, int b) {
+        uint64_t key = ((uint64_t) op << 60) | ((uint64_t) a << 30) | (uint64_t) b;
+        unordered_map<uint64_t, int>::iterator found = unique.find(key);
+        if (found != unique.end()) {
+            return found->second;
         }
+        nodes.push_back({op, a, b});
+        unique[key] = nodes.size() - 1;
+        return nodes.size() - 1;
+    }
+
+    public:
+    vector<ExprNode> nodes;
 
-        bool checkExistence(Group *group, int direction, int target) {
-            int groupSize = group->elements.size();
-            Cell *currCell;
-            for (int x = 0; x < groupSize; x++) {
-                currCell = group->elements.at(x)->adjacencies.at(direction);
-                if (currCell->value != target &&  currCell->value != 2) {
-                    return false;
+    ExpressionGraph() {
+        find(PUSH_CONST, 0, 0);
+        find(PUSH_CONST, 1, 0);
+    }
+    bool isConstant(int node) const {
+        return node < 2;
+    }
+    int variable(int slot) {
+        return find(PUSH_VAR, slot, 0);
+    }
+    //Operations fold constants and trivial cases so cofactors shrink as variables are fixed
+    int makeNot(int x) {
+        if (isConstant(x)) {
+            return 1 - x;
+        }
+        if (nodes[x].op == NOT_OP) {
+            return nodes[x].a;
+        }
+        return find(NOT_OP, x, 0);
+    }
+    bool complementary(int x, int y) const {
+        return (nodes[x].op == NOT_OP && nodes[x].a == y) || (nodes[y].op == NOT_OP && nodes[y].a == x);
+    }
+    int makeAnd(int x, int y) {
+        if (x == 0 || y == 0 || complementary(x, y)) {
+            return 0;
+        }
+        if (x == 1 || x == y) {
+            return y;
+        }
+        if (y == 1) {
+            return x;
+        }
+        return find(AND_OP, min(x, y), max(x, y));
+    }
+    int makeOr(int x, int y) {
+        if (x == 1 || y == 1 || complementary(x, y)) {
+            return 1;
+        }
+        if (x == 0 || x == y) {
+            return y;
+        }
+        if (y == 0) {
+            return x;
+        }
+        return find(OR_OP, min(x, y), max(x, y));
+    }
+    int fromCompiled(const CompiledExpression &compiled) {
+        vector<int> stack;
+        for (const Instruction &instruction : compiled.code) {
+            if (instruction.op == PUSH_VAR) {
+                stack.push_back(variable(instruction.arg));
+            }
+            else if (instruction.op == PUSH_CONST) {
+                stack.push_back(instruction.arg);
+            }
+            else if (instruction.op == NOT_OP) {
+                stack.back() = makeNot(stack.back());
+            }
+            else {
+                int y = stack.back();
+                stack.pop_back();
+                stack.back() = instruction.op == AND_OP ? makeAnd(stack.back(), y) : makeOr(stack.back(), y);
+            }
+        }
+        return stack.back();
+    }
+    //Node for x with variable slot fixed to value, memo holds the cofactors already made in this call
+    //Nodes are visited with an explicit stack, so deeply nested expressions do not recurse
+    int cofactor(int x, int slot, int value, unordered_map<int, int> &memo) {
+        vector<pair<int, bool>> pending = {{x, false}};//Node and whether its operands' cofactors are already in memo
+        while (!pending.empty()) {
+            pair<int, bool> top = pending.back();
+            if (isConstant(top.first) || (!top.second && memo.count(top.first))) {
+                pending.pop_back();
+                continue;
+            }
+            ExprNode node = nodes[top.first];
+            bool hasOperands = node.op == NOT_OP || node.op == AND_OP || node.op == OR_OP;
+            if (hasOperands && !top.second) {
+                //The first operand is pushed last so it is made first, as a recursive walk would
+                pending.back().second = true;
+                if (node.op != NOT_OP) {
+                    pending.push_back({node.b, false});
                 }
+                pending.push_back({node.a, false});
+                continue;
             }
-            return true;
+            pending.pop_back();
+            int result;
+            switch (node.op) {
+                case PUSH_VAR:
+                    result = node.a == slot ? value : top.first;
+                    break;
+                case NOT_OP:
+                    result = makeNot(cofactorOf(node.a, memo));
+                    break;
+                case AND_OP:
+                    result = makeAnd(cofactorOf(node.a, memo), cofactorOf(node.b, memo));
+                    break;
+                case OR_OP:
+                    result = makeOr(cofactorOf(node.a, memo), cofactorOf(node.b, memo));
+                    break;
+                default:
+                    result = top.first;
+            }
+            memo[top.first] = result;
         }
+        return cofactorOf(x, memo);
+    }
+    //Cofactor of x already made by cofactor()
+    int cofactorOf(int x, const unordered_map<int, int> &memo) const {
+        return isConstant(x) ? x : memo.at(x);
+    }
+    //Nodes reachable from x, each after its operands, so evaluating them in order needs no recursion or lookups
+    vector<int> postOrder(int x) {
+        vector<int> order;
+        unordered_map<int, bool> visited;
+        vector<pair<int, bool>> pending = {{x, false}};//Node and whether its operands are already listed
+        while (!pending.empty()) {
+            pair<int, bool> top = pending.back();
+            pending.pop_back();
+            if (top.second) {
+                order.push_back(top.first);
+                continue;
+            }
+            if (visited[top.first]) {
+                continue;
+            }
+            visited[top.first] = true;
+            pending.push_back({top.first, true});
+            ExprNode node = nodes[top.first];
+            if (node.op == NOT_OP || node.op == AND_OP || node.op == OR_OP) {
+                pending.push_back({node.a, false});
+            }
+            if (node.op == AND_OP || node.op == OR_OP) {
+                pending.push_back({node.b, false});
+            }
+        }
+        return order;
+    }
+};
 
-        bool checkExistence(Group *group, int direction, int target, string row) {
-            int groupSize = group->elements.size();
-            Cell *currCell;
-            if (row == "row") {
-                for (int x = 0; x < groupSize; x++) {
-                    currCell = group->elements.at(x)->adjacencies.at(direction);
-                    for (int y = 0; y < 3; y++) {
-                        if (currCell->value != target &&  currCell->value != 2) {
-                            return false;
-                        }
-                        currCell = currCell->adjacencies.at(direction);
-                    }
-                    //return true;
+const uint64_t SHANNON_LEAF_ROWS = 1 << 16;//Cofactors with this many rows or fewer are evaluated bit-parallel
+
+//Fills a packed truth table by cofactoring the expression one variable at a time, in row order
+//Constant cofactors fill their rows directly, and a cofactor already built for the same variable is copied instead of rebuilt
+class ShannonBuilder {
+    ExpressionGraph graph;
+    int varCount;
+    vector<uint64_t> &table;
+    unordered_map<uint64_t, uint64_t> built;//(node, variable) of each finished cofactor to its first row
+
+    //Writes the low rows bits of value to the rows starting at firstRow, rows is a power of 2 and firstRow a multiple of it
+    void writeRows(uint64_t firstRow, uint64_t rows, uint64_t value) {
+        if (rows >= 64) {
+            fill(table.begin() + firstRow / 64, table.begin() + (firstRow + rows) / 64, value);
+        }
+        else {
+            uint64_t mask = (1ull << rows) - 1;
+            table[firstRow / 64] = (table[firstRow / 64] & ~(mask << (firstRow % 64))) | ((value & mask) << (firstRow % 64));
+        }
+    }
+    void copyRows(uint64_t fromRow, uint64_t toRow, uint64_t rows) {
+        if (rows >= 64) {
+            copy(table.begin() + fromRow / 64, table.begin() + (fromRow + rows) / 64, table.begin() + toRow / 64);
+        }
+        else {
+            writeRows(toRow, rows, table[fromRow / 64] >> (fromRow % 64));
+        }
+    }
+    //Evaluates the cofactor node over its rows bit-parallel, one word (or the part of one word) at a time
+    void evalRows(int node, int var, uint64_t firstRow) {
+        uint64_t rows = 1ull << (varCount - var);
+        //Flatten the cofactor so operands refer to earlier entries of program instead of graph nodes
+        vector<int> order = graph.postOrder(node);
+        unordered_map<int, int> position;
+        vector<ExprNode> program;
+        for (int x = 0; x < order.size(); x++) {
+            ExprNode current = graph.nodes[order[x]];
+            if (current.op == NOT_OP || current.op == AND_OP || current.op == OR_OP) {
+                current.a = position[current.a];
+            }
+            if (current.op == AND_OP || current.op == OR_OP) {
+                current.b = position[current.b];
+            }
+            position[order[x]] = x;
+            program.push_back(current);
+        }
+        vector<uint64_t> values(program.size());
+        for (uint64_t word = firstRow / 64; word * 64 < firstRow + rows; word++) {
+            for (int x = 0; x < program.size(); x++) {
+                const ExprNode &current = program[x];
+                switch (current.op) {
+                    case PUSH_VAR:
+                        values[x] = inputWord(current.a, varCount, word);
+                        break;
+                    case PUSH_CONST:
+                        values[x] = current.a ? ~0ull : 0ull;
+                        break;
+                    case NOT_OP:
+                        values[x] = ~values[current.a];
+                        break;
+                    case AND_OP:
+                        values[x] = values[current.a] & values[current.b];
+                        break;
+                    case OR_OP:
+                        values[x] = values[current.a] | values[current.b];
+                        break;
                 }
-                return true;
             }
-            else {
-                cout << "Invalid input" << endl;
-                return false;
+            //Only a table with fewer than 64 rows has a cofactor starting part way through a word
+            writeRows(max(firstRow, word * 64), min(rows, (uint64_t) 64), values.back() >> (firstRow % 64));
+        }
+    }
+    void build(int node, int var, uint64_t firstRow) {
+        uint64_t rows = 1ull << (varCount - var);
+        if (graph.isConstant(node)) {
+            writeRows(firstRow, rows, node ? ~0ull : 0ull);
+            return;
+        }
+        uint64_t key = ((uint64_t) node << 8) | var;
+        unordered_map<uint64_t, uint64_t>::iterator found = built.find(key);
+        if (found != built.end()) {
+            copyRows(found->second, firstRow, rows);
+            return;
+        }
+        if (rows <= SHANNON_LEAF_ROWS) {
+            evalRows(node, var, firstRow);
+        }
+        else {
+            unordered_map<int, int> lowMemo;
+            unordered_map<int, int> highMemo;
+            int low = graph.cofactor(node, var, 0, lowMemo);
+            int high = graph.cofactor(node, var, 1, highMemo);
+            build(low, var + 1, firstRow);
+            build(high, var + 1, firstRow + rows / 2);
+        }
+        built[key] = firstRow;
+    }
+
+    public:
+    ShannonBuilder(const CompiledExpression &compiled, vector<uint64_t> &table) : table(table) {
+        varCount = compiled.varCount;
+        int root = graph.fromCompiled(compiled);
+        build(root, 0, 0);
+    }
+};
+
+//Evaluates a compiled expression over all 2^n input assignments by Shannon expansion
+//Same result and layout as packedTruthTable, but expressions whose cofactors repeat or turn constant are built far faster
+vector<uint64_t> shannonTruthTable(const CompiledExpression &compiled) {
+    vector<uint64_t> table(((1ull << compiled.varCount) + 63) / 64);
+    ShannonBuilder(compiled, table);
+    return table;
+}
+//Shannon expansion truth table code above
+
+//A single column in a truth table, packed 64 rows per word as two bit planes
+//A row is 1 when set in on, don't care when set in dontCare and 0 otherwise, the planes never share a row
+struct TruthColumn {
+    string name;
+    uint64_t rowCount;
+    vector<uint64_t> on;
+    vector<uint64_t> dontCare;
+    TruthColumn(string name, uint64_t rowCount) {
+        this->name = name;
+        this->rowCount = rowCount;
+        on.assign((rowCount + 63) / 64, 0);
+        dontCare.assign(on.size(), 0);
+    }
+    //Returns the value of a row (0, 1 or 2 for don't care)
+    int valueAt(uint64_t row) const {
+        if ((dontCare[row / 64] >> (row % 64)) & 1) {
+            return 2;
+        }
+        return (on[row / 64] >> (row % 64)) & 1;
+    }
+    void setValue(uint64_t row, int value) {
+        uint64_t bit = 1ull << (row % 64);
+        on[row / 64] = value == 1 ? on[row / 64] | bit : on[row / 64] & ~bit;
+        dontCare[row / 64] = value == 2 ? dontCare[row / 64] | bit : dontCare[row / 64] & ~bit;
+    }
+    //Rows whose value equals value, packed 64 rows per word with the rows past rowCount clear
+    vector<uint64_t> rowsWith(int value) const {
+        if (value == 1) {
+            return on;
+        }
+        if (value == 2) {
+            return dontCare;
+        }
+        vector<uint64_t> rows(on.size());
+        for (uint64_t x = 0; x < rows.size(); x++) {
+            rows[x] = ~(on[x] | dontCare[x]);
+        }
+        if (rowCount % 64 != 0) {
+            rows.back() &= (1ull << (rowCount % 64)) - 1;
+        }
+        return rows;
+    }
+};
+
+//A truth table of a single output over its inputs in binary ascending order
+//Only the output is stored, input columns follow from the row index and are built on demand
+class TruthTable {
+    vector<string> inputNames;//Input names, most significant row bit first
+    public:
+    unique_ptr<TruthColumn> output;
+    //Constructor to build truth table out of a string representing a boolean function
+    //Variables are found in the expression and ordered alphabetically, rows are built by Shannon expansion
+    TruthTable(string expression) {
+        inputNames = findVariables(expression);
+        output.reset(new TruthColumn("f", 1ull << inputNames.size()));
+        output->on = shannonTruthTable(compileExpression(expression, inputNames));
+    }
+    //Constructor from one output value per row (0, 1 or 2 for don't care), assumes output is in binary ascending order
+    TruthTable(vector<string> inputNames, string outputName, const vector<int> &outputs) {
+        this->inputNames = inputNames;
+        output.reset(new TruthColumn(outputName, 1ull << inputNames.size()));
+        for (uint64_t x = 0; x < outputs.size() && x < output->rowCount; x++) {
+            output->setValue(x, outputs[x]);
+        }
+    }
+    //Constructor from packed on and don't care planes, don't care wins where both are set
+    TruthTable(vector<string> inputNames, string outputName, const vector<uint64_t> &on, const vector<uint64_t> &dontCare) {
+        this->inputNames = inputNames;
+        output.reset(new TruthColumn(outputName, 1ull << inputNames.size()));
+        for (uint64_t x = 0; x < output->on.size(); x++) {
+            output->dontCare[x] = x < dontCare.size() ? dontCare[x] : 0;
+            output->on[x] = (x < on.size() ? on[x] : 0) & ~output->dontCare[x];
+        }
+        if (output->rowCount % 64 != 0) {
+            output->on.back() &= (1ull << (output->rowCount % 64)) - 1;
+            output->dontCare.back() &= (1ull << (output->rowCount % 64)) - 1;
+        }
+    }
+    int inputCount() const {
+        return inputNames.size();
+    }
+    string inputName(int var) const {
+        return inputNames.at(var);
+    }
+    uint64_t rowCount() const {
+        return output->rowCount;
+    }
+    //Returns value of input var at a row, read straight from the row index
+    int inputAt(int var, uint64_t row) const {
+        return (row >> (inputNames.size() - 1 - var)) & 1;
+    }
+    //Input column of var packed 64 rows per word
+    vector<uint64_t> inputColumn(int var) const {
+        return packedInputColumn(var, inputNames.size());
+    }
+    //Returns value of output at an entered index
+    int outputAt(uint64_t index) const {
+        if (index >= output->rowCount) {
+            throw out_of_range("Row " + to_string(index) + " is outside the truth table");
+        }
+        return output->valueAt(index);
+    }
+    //Rows whose output equals value (0, 1 or 2 for don't care), packed 64 rows per word
+    vector<uint64_t> packedOutput(int value) const {
+        return output->rowsWith(value);
+    }
+    //BDD of the rows whose output equals value
+    BddEdge toBdd(BddManager &manager, int value) {
+        return bddFromPackedTable(manager, packedOutput(value), inputNames.size());
+    }
+};
+
+//A group of cells stored as a cube: every cell m with (m & ~mask) == value
+//Bit (varCount - 1 - y) of a cell holds variable y, so cells adjacent in the kmap differ in exactly one bit
+struct Group {
+    uint64_t value;//Bits shared by every cell in the group, zero wherever mask is set
+    uint64_t mask;//Bits of the variables eliminated by the group
+    Group(uint64_t value, uint64_t mask) {
+        this->value = value;
+        this->mask = mask;
+    }
+    uint64_t size() const {
+        return 1ull << popcount64(mask);
+    }
+    //The group doubled across the bits in shift
+    Group extend(uint64_t shift) const {
+        return Group(value & ~shift, mask | shift);
+    }
+    bool operator==(const Group &other) const {
+        return value == other.value && mask == other.mask;
+    }
+    //Calls visit with every cell in the group by walking the subsets of mask
+    template <class Visit>
+    void forEach(Visit visit) const {
+        uint64_t bits = 0;
+        do {
+            visit(value | bits);
+            bits = (bits - mask) & mask;
+        } while (bits != 0);
+    }
+    //Calls visit(word, bits) with every word of a packed table the group meets and the bits of its cells in that word
+    //The low six bits of a cell pick its bit within a word and the rest pick the word
+    template <class Visit>
+    void forEachWord(Visit visit) const {
+        uint64_t pattern = ~0ull;
+        for (int bit = 0; bit < 6; bit++) {
+            if (((mask >> bit) & 1) == 0) {
+                pattern &= ((value >> bit) & 1) ? LOW_ROW_PATTERNS[bit] : ~LOW_ROW_PATTERNS[bit];
+            }
+        }
+        Group(value >> 6, mask >> 6).forEach([&](uint64_t word) {visit(word, pattern);});
+    }
+
+    //For debugging purposes
+    void Print() const {
+        forEach([](uint64_t cell) {cout << cell << " " << flush;});
+        cout << endl;
+    }
+};
+
+//Statistics code below
+//Phases of solving are timed on a monotonic clock and tallied with counts of what they made, for --stats to print as JSON
+//Nothing is recorded unless a SolveStats is handed in, and built with KMAP_STATS set to 0 the timers and counts compile to nothing
+#ifndef KMAP_STATS
+#define KMAP_STATS 1
+#endif
+
+//Calls to operator new while countAllocations is set, counted by programs that replace operator new
+atomic<uint64_t> allocationCount(0);
+bool countAllocations = false;
+
+struct SolveStats {
+    struct Phase {
+        string name;
+        double seconds = 0;
+        uint64_t allocations = 0;
+        uint64_t calls = 0;
+    };
+    vector<Phase> phases;//In the order each first ran
+    vector<pair<string, uint64_t>> counters;
+
+    void addPhase(const string &name, double seconds, uint64_t allocations, uint64_t calls = 1) {
+        for (Phase &phase : phases) {
+            if (phase.name == name) {
+                phase.seconds += seconds;
+                phase.allocations += allocations;
+                phase.calls += calls;
+                return;
+            }
+        }
+        Phase phase;
+        phase.name = name;
+        phase.seconds = seconds;
+        phase.allocations = allocations;
+        phase.calls = calls;
+        phases.push_back(phase);
+    }
+    void count(const string &name, uint64_t amount) {
+        for (pair<string, uint64_t> &counter : counters) {
+            if (counter.first == name) {
+                counter.second += amount;
+                return;
+            }
+        }
+        counters.push_back(make_pair(name, amount));
+    }
+    //Adds the phases and counts of other, such as another function of a batch
+    void merge(const SolveStats &other) {
+        for (const Phase &phase : other.phases) {
+            addPhase(phase.name, phase.seconds, phase.allocations, phase.calls);
+        }
+        for (const pair<string, uint64_t> &counter : other.counters) {
+            count(counter.first, counter.second);
+        }
+    }
+    string json() const {
+        ostringstream out;
+        double total = 0;
+        uint64_t allocations = 0;
+        out << "{\"phases\": [";
+        for (int x = 0; x < phases.size(); x++) {
+            out << (x == 0 ? "" : ", ") << "{\"name\": \"" << phases[x].name << "\", \"seconds\": " << phases[x].seconds
+                << ", \"allocations\": " << phases[x].allocations << ", \"calls\": " << phases[x].calls << "}";
+            total += phases[x].seconds;
+            allocations += phases[x].allocations;
+        }
+        out << "], \"total_seconds\": " << total << ", \"total_allocations\": " << allocations << ", \"counters\": {";
+        for (int x = 0; x < counters.size(); x++) {
+            out << (x == 0 ? "" : ", ") << "\"" << counters[x].first << "\": " << counters[x].second;
+        }
+        out << "}}";
+        return out.str();
+    }
+};
+
+//Adds the time and allocations between its construction and destruction to a phase of stats, doing nothing when stats is null
+class PhaseTimer {
+    SolveStats *stats;
+    const char *name;
+    chrono::steady_clock::time_point start;
+    uint64_t allocationsAtStart;
+    public:
+    PhaseTimer(SolveStats *stats, const char *name) {
+        this->stats = stats;
+        this->name = name;
+        if (stats != nullptr) {
+            start = chrono::steady_clock::now();
+            allocationsAtStart = allocationCount.load(memory_order_relaxed);
+        }
+    }
+    ~PhaseTimer() {
+        if (stats != nullptr) {
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            stats->addPhase(name, elapsed.count(), allocationCount.load(memory_order_relaxed) - allocationsAtStart);
+        }
+    }
+};
+
+#if KMAP_STATS
+#define STATS_PHASE(stats, name) PhaseTimer phaseTimer(stats, name)
+#define STATS_COUNT(stats, name, amount) do {if ((stats) != nullptr) {(stats)->count(name, amount);}} while (false)
+#else
+#define STATS_PHASE(stats, name)
+#define STATS_COUNT(stats, name, amount)
+#endif
+//Statistics code above
+
+//Work stealing thread pool code below
+//run() hands each thread a contiguous range of the task indices, a thread takes tasks from the front of its own range
+//and once that is empty steals from the back of another thread's range, so uneven tasks still keep every thread busy
+//Callers give each task its own output and combine them in task order afterwards, so results never depend on the thread count
+class WorkPool {
+    struct Range {
+        mutex lock;
+        int begin = 0;
+        int end = 0;
+    };
+    vector<unique_ptr<Range>> ranges;//One per thread, the calling thread being the first
+    vector<thread> threads;
+    mutex lock;
+    condition_variable wake;
+    condition_variable done;
+    const function<void(int)> *task = nullptr;
+    uint64_t generation = 0;//Counts calls to run() so a waiting thread knows there is new work
+    int remaining = 0;//Threads yet to finish the current call
+    bool stopping = false;
+
+    bool take(int self, int &index) {
+        {
+            lock_guard<mutex> guard(ranges[self]->lock);
+            if (ranges[self]->begin < ranges[self]->end) {
+                index = ranges[self]->begin++;
+                return true;
+            }
+        }
+        for (int x = 1; x < ranges.size(); x++) {
+            Range &other = *ranges[(self + x) % ranges.size()];
+            lock_guard<mutex> guard(other.lock);
+            if (other.begin < other.end) {
+                index = --other.end;
+                return true;
+            }
+        }
+        return false;
+    }
+    void work(int self) {
+        int index;
+        while (take(self, index)) {
+            (*task)(index);
+        }
+    }
+    void loop(int self) {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                unique_lock<mutex> guard(lock);
+                wake.wait(guard, [&]() {return stopping || generation != seen;});
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+            work(self);
+            lock_guard<mutex> guard(lock);
+            if (--remaining == 0) {
+                done.notify_one();
+            }
+        }
+    }
+
+    public:
+    //A pool of one thread runs every task on the calling thread
+    WorkPool(int threadCount) {
+        threadCount = max(threadCount, 1);
+        for (int x = 0; x < threadCount; x++) {
+            ranges.push_back(unique_ptr<Range>(new Range()));
+        }
+        for (int x = 1; x < threadCount; x++) {
+            threads.push_back(thread(&WorkPool::loop, this, x));
+        }
+    }
+    ~WorkPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread &worker : threads) {
+            worker.join();
+        }
+    }
+    int size() const {
+        return ranges.size();
+    }
+    //Calls task(x) for every x from 0 to count - 1 and returns once all of them are done
+    void run(int count, const function<void(int)> &task) {
+        if (threads.empty()) {
+            for (int x = 0; x < count; x++) {
+                task(x);
+            }
+            return;
+        }
+        for (int x = 0; x < ranges.size(); x++) {
+            lock_guard<mutex> guard(ranges[x]->lock);
+            ranges[x]->begin = (int64_t) count * x / ranges.size();
+            ranges[x]->end = (int64_t) count * (x + 1) / ranges.size();
+        }
+        {
+            lock_guard<mutex> guard(lock);
+            this->task = &task;
+            remaining = threads.size();
+            generation++;
+        }
+        wake.notify_all();
+        work(0);
+        unique_lock<mutex> guard(lock);
+        done.wait(guard, [&]() {return remaining == 0;});
+    }
+};
+//Work stealing thread pool code above
+
+//Quine-McCluskey prime implicant code below
+//Cubes are merged a level at a time, where level k holds the cubes eliminating k variables
+//Each level is bucketed by the number of 1 bits in a cube's value, and cubes merge when they share a mask and their values differ in one bit
+//so a cube in bucket p only ever merges with bucket p + 1, and the merged cube lands in bucket p of the next level
+//Several functions of the same inputs may be handled at once, each cube carrying a mask of the outputs it is an implicant of
+//A merged cube is only an implicant of the outputs both halves are, and a half is not prime if the merged cube keeps all its outputs
+struct GroupHash {
+    size_t operator()(const Group &group) const {
+        uint64_t hash = (group.value ^ (group.mask * 0x9E3779B97F4A7C15ull)) * 0xBF58476D1CE4E5B9ull;
+        return hash ^ (hash >> 31);
+    }
+};
+
+typedef vector<vector<Group>> CubeLevel;
+typedef vector<vector<uint64_t>> CubeOutputs;
+
+//Open addressing hash table from cubes to their position in a bucket
+//Levels take millions of lookups, which a node based map spends mostly on cache misses
+class CubeTable {
+    struct Slot {
+        Group group;
+        int position;
+    };
+    vector<Slot> slots;//Each cube is kept beside its position so a probe touches one cache line
+    uint64_t slotMask = 0;
+    size_t count = 0;
+    static Group empty() {
+        return Group(~0ull, ~0ull);//Not a valid cube since value and mask never share a bit
+    }
+    void grow() {
+        vector<Slot> oldSlots;
+        oldSlots.swap(slots);
+        reset(oldSlots.size());
+        for (const Slot &slot : oldSlots) {
+            if (!(slot.group == empty())) {
+                insert(slot.group, slot.position);
+            }
+        }
+    }
+    public:
+    //Empties the table, sized so that expected cubes fit without growing
+    void reset(size_t expected) {
+        size_t capacity = 16;
+        while (capacity < 2 * expected) {
+            capacity *= 2;
+        }
+        slots.assign(capacity, Slot{empty(), -1});
+        slotMask = capacity - 1;
+        count = 0;
+    }
+    //Position stored with a cube, or -1 if it is absent
+    int find(const Group &group) const {
+        for (uint64_t x = GroupHash()(group) & slotMask; ; x = (x + 1) & slotMask) {
+            if (slots[x].group == group) {
+                return slots[x].position;
+            }
+            if (slots[x].group == empty()) {
+                return -1;
+            }
+        }
+    }
+    //Adds a cube unless it is already present, returning whether it was added
+    bool insert(const Group &group, int position) {
+        if (2 * (count + 1) > slots.size()) {
+            grow();
+        }
+        uint64_t x = GroupHash()(group) & slotMask;
+        while (!(slots[x].group == empty())) {
+            if (slots[x].group == group) {
+                return false;
+            }
+            x = (x + 1) & slotMask;
+        }
+        slots[x] = Slot{group, position};
+        count++;
+        return true;
+    }
+};
+
+//Checks whether any cell of a group is set in bits
+bool coversAny(const Group &group, const vector<uint64_t> &bits) {
+    bool covers = false;
+    group.forEach([&](uint64_t cell) {
+        covers = covers || ((bits[cell / 64] >> (cell % 64)) & 1);
+    });
+    return covers;
+}
+
+class PrimeGenerator {
+    int varCount;
+    CubeLevel level;
+    CubeOutputs levelOutputs;//Outputs of each cube of the current level, one bit per output
+    vector<CubeTable> index;//Position of each cube of the current level within its bucket
+    vector<Group> primes;
+    vector<uint64_t> primeOutputs;
+
+    //A run of cubes from one bucket of the current level, merged as one task
+    //Large buckets are split across several chunks so the work spreads evenly over the threads
+    struct Chunk {
+        int bucket;
+        int begin;
+        int end;
+        vector<Group> merged;//Cubes formed for the same bucket of the next level
+        vector<uint64_t> mergedOutputs;
+        vector<Group> primes;
+        vector<uint64_t> primeOutputs;
+    };
+    static const int chunkSize = 4096;
+
+    //Checks whether a cube covers a target of any of its outputs
+    static bool coversTarget(const Group &group, uint64_t outputs, const vector<vector<uint64_t>> &targets) {
+        for (int output = 0; output < targets.size(); output++) {
+            if (((outputs >> output) & 1) && coversAny(group, targets[output])) {
+                return true;
+            }
+        }
+        return false;
+    }
+    //Merges each cube of a chunk with its neighbours in the bucket above, and keeps it as a prime if no neighbour
+    //above or below merges with it keeping all its outputs
+    //Only writes to the chunk, so chunks may be merged at the same time
+    void mergeChunk(Chunk &chunk, const vector<vector<uint64_t>> &targets) {
+        int p = chunk.bucket;
+        uint64_t allBits = (varCount == 64) ? ~0ull : (1ull << varCount) - 1;
+        for (int x = chunk.begin; x < chunk.end; x++) {
+            const Group &group = level[p][x];
+            uint64_t outputs = levelOutputs[p][x];
+            bool merged = false;
+            //A merged cube can be formed across any bit of its mask, so it is only kept when formed across the lowest one
+            //Both halves of every implicant are present in the level below, so this still yields each merged cube exactly once
+            uint64_t lowest = group.mask & (~group.mask + 1);
+            uint64_t free = allBits & ~group.mask & ~group.value;
+            while (free != 0) {
+                uint64_t bit = free & (~free + 1);
+                free ^= bit;
+                bool kept = lowest == 0 || bit < lowest;
+                if (!kept && merged) {
+                    break;
+                }
+                int partner = index[p + 1].find(Group(group.value | bit, group.mask));
+                if (partner < 0) {
+                    continue;
+                }
+                uint64_t shared = outputs & levelOutputs[p + 1][partner];
+                if (shared == 0) {
+                    continue;
+                }
+                merged = merged || shared == outputs;
+                if (kept) {
+                    chunk.merged.push_back(group.extend(bit));
+                    chunk.mergedOutputs.push_back(shared);
+                }
+            }
+            for (uint64_t bits = group.value; bits != 0 && !merged; bits &= bits - 1) {
+                int partner = index[p - 1].find(Group(group.value ^ (bits & (~bits + 1)), group.mask));
+                merged = partner >= 0 && (levelOutputs[p - 1][partner] & outputs) == outputs;
+            }
+            if (!merged && coversTarget(group, outputs, targets)) {
+                chunk.primes.push_back(group);
+                chunk.primeOutputs.push_back(outputs);
+            }
+        }
+    }
+
+    public:
+    //targets[i] and dontCares[i] are the packed tables of output i, at most 64 outputs
+    //Cells set in some output's targets or dontCares start as level 0, only primes covering a target of one of their outputs are kept
+    PrimeGenerator(const vector<vector<uint64_t>> &targets, const vector<vector<uint64_t>> &dontCares, int varCount, WorkPool &pool) {
+        this->varCount = varCount;
+        level.resize(varCount + 1);
+        levelOutputs.resize(varCount + 1);
+        for (uint64_t word = 0; word < targets[0].size(); word++) {
+            uint64_t bits = 0;
+            for (int output = 0; output < targets.size(); output++) {
+                bits |= targets[output][word] | dontCares[output][word];
+            }
+            while (bits != 0) {
+                int offset = popcount64((bits & (~bits + 1)) - 1);
+                uint64_t cell = word * 64 + offset;
+                bits &= bits - 1;
+                uint64_t outputs = 0;
+                for (int output = 0; output < targets.size(); output++) {
+                    outputs |= (((targets[output][word] | dontCares[output][word]) >> offset) & 1) << output;
+                }
+                level[popcount64(cell)].push_back(Group(cell, 0));
+                levelOutputs[popcount64(cell)].push_back(outputs);
+            }
+        }
+        bool empty = false;
+        while (!empty) {
+            int bucketCount = level.size();
+            index.resize(bucketCount);
+            pool.run(bucketCount, [&](int p) {
+                index[p].reset(level[p].size());
+                for (int x = 0; x < level[p].size(); x++) {
+                    index[p].insert(level[p][x], x);
+                }
+            });
+            vector<Chunk> chunks;
+            for (int p = 0; p < bucketCount; p++) {
+                for (int begin = 0; begin < level[p].size(); begin += chunkSize) {
+                    Chunk chunk;
+                    chunk.bucket = p;
+                    chunk.begin = begin;
+                    chunk.end = min<int>(begin + chunkSize, level[p].size());
+                    chunks.push_back(chunk);
+                }
+            }
+            pool.run(chunks.size(), [&](int x) {
+                mergeChunk(chunks[x], targets);
+            });
+            //Chunks are combined in order, giving the same cubes in the same order for any number of threads
+            CubeLevel next(bucketCount);
+            CubeOutputs nextOutputs(bucketCount);
+            empty = true;
+            for (Chunk &chunk : chunks) {
+                next[chunk.bucket].insert(next[chunk.bucket].end(), chunk.merged.begin(), chunk.merged.end());
+                nextOutputs[chunk.bucket].insert(nextOutputs[chunk.bucket].end(), chunk.mergedOutputs.begin(), chunk.mergedOutputs.end());
+                primes.insert(primes.end(), chunk.primes.begin(), chunk.primes.end());
+                primeOutputs.insert(primeOutputs.end(), chunk.primeOutputs.begin(), chunk.primeOutputs.end());
+                empty = empty && chunk.merged.empty();
+            }
+            level.swap(next);
+            levelOutputs.swap(nextOutputs);
+        }
+    }
+    //Primes ordered by size, then by the bucket and order they were formed in
+    vector<Group> &getPrimes() {
+        return primes;
+    }
+    //Outputs each prime is an implicant of, in the order of getPrimes
+    vector<uint64_t> &getPrimeOutputs() {
+        return primeOutputs;
+    }
+};
+
+//Finds every prime implicant of the function whose ON-set is targets
+//pool runs the merging, nullptr meaning the calling thread alone
+vector<Group> primeImplicants(const vector<uint64_t> &targets, const vector<uint64_t> &dontCares, int varCount, WorkPool *pool = nullptr) {
+    WorkPool serial(1);
+    PrimeGenerator generator({targets}, {dontCares}, varCount, pool ? *pool : serial);
+    return generator.getPrimes();
+}
+//Quine-McCluskey prime implicant code above
+
+//Exact minimum cover code below
+//Chooses the fewest groups covering every target cell, posed as a unate covering problem:
+//rows are the target cells, columns are the groups, and a column covers the rows of the cells in its group
+//Essential columns, dominated rows and dominated columns are removed first, then the cyclic core left over is searched by branch and bound
+
+//Limits on the branch and bound search, zero meaning no limit
+//When a limit is hit the best cover found so far is used, which may not be minimal
+struct CoverBudget {
+    uint64_t maxNodes = 0;
+    double maxSeconds = 0;
+};
+
+class CoverSolver {
+    vector<vector<int>> rowColumns;//Columns covering each row, ascending
+    vector<vector<int>> columnRows;//Rows covered by each column, ascending
+    vector<char> rowActive;
+    vector<char> columnActive;
+    vector<int> chosen;//Columns already known to be in the cover
+
+    //Cyclic core, searched with the uncovered core rows packed 64 per word
+    //A node of the search: the core rows still uncovered, the core columns left out and the columns chosen to reach it
+    //Every branch works on its own copy, so the search shares nothing between branches but the best cover and the budget
+    struct CoverNode {
+        vector<uint64_t> uncovered;
+        vector<uint64_t> excluded;
+        vector<int> current;
+    };
+    vector<int> coreColumns;//Column index of each core column
+    //A core column keeps its rows packed the same way, only the words holding some of them,
+    //so covering, counting and comparing columns are ANDs and popcounts over a few words
+    vector<int> rowsStart;//Core column c's rows are the words rowWords[rowsStart[c]] up to rowWords[rowsStart[c + 1]], ascending
+    vector<int> rowWords;
+    vector<uint64_t> rowBits;//Core rows of each word in rowWords
+    vector<vector<int>> coreRowColumns;//Core columns covering each core row
+    vector<int> rowOrder;//Core rows by ascending number of columns, for the lower bound
+    vector<int> columnStamps;
+    int stamp = 0;
+    vector<int> best;
+    CoverBudget budget;
+    WorkPool *pool;//Runs the reductions, nullptr meaning the calling thread alone
+    static const int chunkSize = 1024;
+    uint64_t nodes = 0;
+    chrono::steady_clock::time_point start;
+    bool stopped = false;
+    SolveStats *stats = nullptr;
+
+    static bool isSubset(const vector<int> &small, const vector<int> &large) {
+        for (int item : small) {
+            if (!binary_search(large.begin(), large.end(), item)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    vector<int> activeColumns(int row) {
+        vector<int> columns;
+        for (int column : rowColumns[row]) {
+            if (columnActive[column]) {
+                columns.push_back(column);
+            }
+        }
+        return columns;
+    }
+    vector<int> activeRows(int column) {
+        vector<int> rows;
+        for (int row : columnRows[column]) {
+            if (rowActive[row]) {
+                rows.push_back(row);
+            }
+        }
+        return rows;
+    }
+    void choose(int column) {
+        chosen.push_back(column);
+        columnActive[column] = 0;
+        for (int row : columnRows[column]) {
+            rowActive[row] = 0;
+        }
+    }
+
+    //Calls visit(chunk, begin, end) on the pool for each run of chunkSize indices below count
+    void forChunks(int count, const function<void(int, int, int)> &visit) {
+        WorkPool serial(1);
+        (pool ? *pool : serial).run((count + chunkSize - 1) / chunkSize, [&](int chunk) {
+            visit(chunk, chunk * chunkSize, min(count, (chunk + 1) * chunkSize));
+        });
+    }
+
+    //The reductions below check every row or column against the state before the pass, in parallel,
+    //and then apply what they found, which removes the same rows and columns as checking them one at a time would
+
+    //Chooses every column that is the only one left covering some row
+    bool takeEssentials() {
+        vector<int> only(rowColumns.size(), -1);
+        forChunks(rowColumns.size(), [&](int, int begin, int end) {
+            for (int row = begin; row < end; row++) {
+                if (rowActive[row]) {
+                    vector<int> columns = activeColumns(row);
+                    if (columns.size() == 1) {
+                        only[row] = columns[0];
+                    }
+                }
+            }
+        });
+        bool changed = false;
+        for (int row = 0; row < rowColumns.size(); row++) {
+            if (only[row] >= 0 && columnActive[only[row]]) {
+                choose(only[row]);
+                changed = true;
+            }
+        }
+        return changed;
+    }
+    //Drops rows whose columns include all the columns of another row, since covering that row covers them too
+    //Of rows with the same columns the first is kept
+    bool removeDominatedRows() {
+        vector<vector<int>> dominated((rowColumns.size() + chunkSize - 1) / chunkSize);
+        forChunks(rowColumns.size(), [&](int chunk, int begin, int end) {
+            for (int row = begin; row < end; row++) {
+                if (!rowActive[row]) {
+                    continue;
+                }
+                vector<int> columns = activeColumns(row);
+                if (columns.empty()) {
+                    continue;
+                }
+                for (int other : columnRows[columns[0]]) {
+                    if (other != row && rowActive[other] && isSubset(columns, rowColumns[other])
+                            && (row < other || activeColumns(other).size() > columns.size())) {
+                        dominated[chunk].push_back(other);
+                    }
+                }
+            }
+        });
+        bool changed = false;
+        for (const vector<int> &rows : dominated) {
+            for (int row : rows) {
+                changed = changed || rowActive[row];
+                rowActive[row] = 0;
+            }
+        }
+        return changed;
+    }
+    //Drops columns whose rows are all covered by another single column
+    //Any such column also covers the column's row with the fewest columns, so only those are compared
+    //Of columns with the same rows the last is kept
+    bool removeDominatedColumns() {
+        vector<char> dominated(columnRows.size(), 0);
+        forChunks(columnRows.size(), [&](int, int begin, int end) {
+            for (int column = begin; column < end; column++) {
+                if (!columnActive[column]) {
+                    continue;
+                }
+                vector<int> rows = activeRows(column);
+                if (rows.empty()) {
+                    dominated[column] = 1;
+                    continue;
+                }
+                int rarest = rows[0];
+                for (int row : rows) {
+                    if (rowColumns[row].size() < rowColumns[rarest].size()) {
+                        rarest = row;
+                    }
+                }
+                for (int other : rowColumns[rarest]) {
+                    if (other != column && columnActive[other] && isSubset(rows, columnRows[other])
+                            && (other > column || activeRows(other).size() > rows.size())) {
+                        dominated[column] = 1;
+                        break;
+                    }
+                }
+            }
+        });
+        bool changed = false;
+        for (int column = 0; column < columnRows.size(); column++) {
+            if (dominated[column]) {
+                columnActive[column] = 0;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    void buildCore() {
+        vector<int> coreRow(rowColumns.size(), -1);
+        int rowCount = 0;
+        for (int row = 0; row < rowColumns.size(); row++) {
+            if (rowActive[row]) {
+                coreRow[row] = rowCount++;
+            }
+        }
+        coreRowColumns.assign(rowCount, vector<int>());
+        rowsStart.push_back(0);
+        for (int column = 0; column < columnRows.size(); column++) {
+            if (!columnActive[column]) {
+                continue;
+            }
+            //Core rows are numbered in the order of the rows, so the words come out ascending
+            for (int row : columnRows[column]) {
+                if (rowActive[row]) {
+                    int core = coreRow[row];
+                    if (rowWords.size() == rowsStart.back() || rowWords.back() != core / 64) {
+                        rowWords.push_back(core / 64);
+                        rowBits.push_back(0);
+                    }
+                    rowBits.back() |= 1ull << (core % 64);
+                    coreRowColumns[core].push_back(coreColumns.size());
+                }
+            }
+            coreColumns.push_back(column);
+            rowsStart.push_back(rowWords.size());
+        }
+        rowOrder.resize(rowCount);
+        for (int row = 0; row < rowCount; row++) {
+            rowOrder[row] = row;
+        }
+        stable_sort(rowOrder.begin(), rowOrder.end(), [this](int a, int b) {
+            return coreRowColumns[a].size() < coreRowColumns[b].size();
+        });
+        columnStamps.assign(coreColumns.size(), 0);
+    }
+    static bool isSet(const vector<uint64_t> &bits, int index) {
+        return (bits[index / 64] >> (index % 64)) & 1;
+    }
+    static void setBit(vector<uint64_t> &bits, int index) {
+        bits[index / 64] |= 1ull << (index % 64);
+    }
+    int countCovered(const vector<uint64_t> &uncovered, int column) {
+        int count = 0;
+        for (int x = rowsStart[column]; x < rowsStart[column + 1]; x++) {
+            count += popcount64(uncovered[rowWords[x]] & rowBits[x]);
+        }
+        return count;
+    }
+    void cover(vector<uint64_t> &uncovered, int column) {
+        for (int x = rowsStart[column]; x < rowsStart[column + 1]; x++) {
+            uncovered[rowWords[x]] &= ~rowBits[x];
+        }
+    }
+    //Whether a column covers every row of rows, given as words of packed rows in ascending order
+    bool coversRows(int column, const vector<pair<int, uint64_t>> &rows) {
+        int x = rowsStart[column];
+        int end = rowsStart[column + 1];
+        for (const pair<int, uint64_t> &word : rows) {
+            while (x < end && rowWords[x] < word.first) {
+                x++;
+            }
+            if (x == end || rowWords[x] != word.first || (word.second & ~rowBits[x]) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+    //Rows sharing no available column each need a different column, so a set of them bounds the columns still needed
+    int independentRows(const CoverNode &node) {
+        stamp++;
+        int count = 0;
+        for (int row : rowOrder) {
+            if (!isSet(node.uncovered, row)) {
+                continue;
+            }
+            bool independent = true;
+            for (int column : coreRowColumns[row]) {
+                independent = independent && (isSet(node.excluded, column) || columnStamps[column] != stamp);
+            }
+            if (independent) {
+                for (int column : coreRowColumns[row]) {
+                    columnStamps[column] = stamp;
+                }
+                count++;
+            }
+        }
+        return count;
+    }
+    bool outOfBudget() {
+        nodes++;
+        if (budget.maxNodes != 0 && nodes > budget.maxNodes) {
+            stopped = true;
+        }
+        if (budget.maxSeconds != 0 && chrono::duration<double>(chrono::steady_clock::now() - start).count() > budget.maxSeconds) {
+            stopped = true;
+            timedOut = true;
+        }
+        return stopped;
+    }
+    //Repeatedly takes the column covering the most uncovered rows, giving the first upper bound
+    void greedyCover(vector<uint64_t> uncovered) {
+        best.clear();
+        //Counts only fall, so a column queued with a stale count is queued again until the top count is current
+        //Ties go to the lowest column
+        vector<int> counts(coreColumns.size());
+        priority_queue<pair<int, int>> ranked;
+        for (int column = 0; column < coreColumns.size(); column++) {
+            counts[column] = countCovered(uncovered, column);
+            ranked.push(make_pair(counts[column], -column));
+        }
+        while (!ranked.empty() && ranked.top().first > 0) {
+            int bestColumn = -ranked.top().second;
+            int queuedCount = ranked.top().first;
+            ranked.pop();
+            if (counts[bestColumn] != queuedCount) {
+                ranked.push(make_pair(counts[bestColumn], -bestColumn));
+                continue;
+            }
+            best.push_back(bestColumn);
+            for (int x = rowsStart[bestColumn]; x < rowsStart[bestColumn + 1]; x++) {
+                int word = rowWords[x];
+                for (uint64_t bits = uncovered[word] & rowBits[x]; bits != 0; bits &= bits - 1) {
+                    int row = word * 64 + popcount64((bits & (~bits + 1)) - 1);
+                    for (int column : coreRowColumns[row]) {
+                        counts[column]--;
+                    }
+                }
+                uncovered[word] &= ~rowBits[x];
+            }
+        }
+    }
+    //Chooses the columns that are the only ones left for some row and leaves out columns covering no more than another column
+    //Returns false if some row has no column left
+    bool reduceNode(CoverNode &node) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int word = 0; word < node.uncovered.size(); word++) {
+                for (uint64_t bits = node.uncovered[word]; bits != 0; bits &= bits - 1) {
+                    int row = word * 64 + popcount64((bits & (~bits + 1)) - 1);
+                    if (!isSet(node.uncovered, row)) {
+                        continue;
+                    }
+                    int only = -1;
+                    int count = 0;
+                    for (int column : coreRowColumns[row]) {
+                        if (!isSet(node.excluded, column)) {
+                            only = column;
+                            count++;
+                        }
+                    }
+                    if (count == 0) {
+                        return false;
+                    }
+                    if (count == 1) {
+                        node.current.push_back(only);
+                        cover(node.uncovered, only);
+                        changed = true;
+                    }
+                }
+            }
+            if (changed) {
+                continue;
+            }
+            //A column can only be covered by another column sharing its uncovered row with the fewest columns
+            vector<pair<int, uint64_t>> rows;
+            for (int column = 0; column < coreColumns.size(); column++) {
+                if (isSet(node.excluded, column)) {
+                    continue;
+                }
+                rows.clear();
+                int rarest = -1;
+                for (int x = rowsStart[column]; x < rowsStart[column + 1]; x++) {
+                    int word = rowWords[x];
+                    uint64_t bits = node.uncovered[word] & rowBits[x];
+                    if (bits != 0) {
+                        rows.push_back(make_pair(word, bits));
+                    }
+                    for (; bits != 0; bits &= bits - 1) {
+                        int row = word * 64 + popcount64((bits & (~bits + 1)) - 1);
+                        if (rarest < 0 || coreRowColumns[row].size() < coreRowColumns[rarest].size()) {
+                            rarest = row;
+                        }
+                    }
+                }
+                if (rows.empty()) {
+                    continue;
+                }
+                for (int other : coreRowColumns[rarest]) {
+                    if (other == column || isSet(node.excluded, other)) {
+                        continue;
+                    }
+                    if (coversRows(other, rows)) {
+                        setBit(node.excluded, column);
+                        changed = true;
+                        break;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+    //Reduces the node in place, so callers hand in a copy of their own
+    void search(CoverNode &node) {
+        if (outOfBudget()) {
+            return;
+        }
+        if (reduceNode(node) && node.current.size() < best.size()) {
+            branch(node);
+        }
+    }
+    void branch(CoverNode &node) {
+        int bound = node.current.size() + independentRows(node);
+        if (bound >= best.size()) {
+            return;
+        }
+        //When one more column would reach the best cover, a column meeting none of the independent rows leaves the bound
+        //where it was and so cannot lead to a better cover, and is left out
+        if (bound + 1 == best.size()) {
+            for (int column = 0; column < coreColumns.size(); column++) {
+                if (columnStamps[column] != stamp) {
+                    setBit(node.excluded, column);
+                }
+            }
+        }
+        //Branch on the uncovered row with the fewest available columns, since one of them must be chosen
+        int branchRow = -1;
+        int branchCount = 0;
+        for (int word = 0; word < node.uncovered.size(); word++) {
+            for (uint64_t bits = node.uncovered[word]; bits != 0; bits &= bits - 1) {
+                int row = word * 64 + popcount64((bits & (~bits + 1)) - 1);
+                int count = 0;
+                for (int column : coreRowColumns[row]) {
+                    count += !isSet(node.excluded, column);
+                }
+                if (branchRow < 0 || count < branchCount) {
+                    branchRow = row;
+                    branchCount = count;
+                }
+            }
+        }
+        if (branchRow < 0) {
+            best = node.current;
+        }
+        else if (branchCount > 0) {
+            branchOn(branchRow, node);
+        }
+    }
+    void branchOn(int branchRow, CoverNode &node) {
+        vector<pair<int, int>> options;
+        for (int column : coreRowColumns[branchRow]) {
+            if (!isSet(node.excluded, column)) {
+                options.push_back(make_pair(-countCovered(node.uncovered, column), column));
+            }
+        }
+        sort(options.begin(), options.end());
+        //Once the branches choosing a column are done, the later branches leave it out so no cover is searched twice
+        for (const pair<int, int> &option : options) {
+            CoverNode next = node;
+            cover(next.uncovered, option.second);
+            next.current.push_back(option.second);
+            search(next);
+            setBit(node.excluded, option.second);
+            if (stopped) {
+                break;
+            }
+        }
+    }
+
+    public:
+    bool exact = true;//False if the budget ran out before the search finished
+    bool timedOut = false;//Whether it ran out at budget.maxSeconds, leaving a result that depends on how fast the search ran
+
+    CoverSolver(const vector<Group> &groups, const vector<uint64_t> &targets, uint64_t cellCount, CoverBudget budget, WorkPool *pool = nullptr)
+        : CoverSolver(groups, vector<uint64_t>(groups.size(), 1), {targets}, cellCount, budget, pool) {}
+    //Covers several outputs at once, with a row for each target cell of each output
+    //A group covers the rows of its cells for the outputs set in its mask in groupOutputs
+    CoverSolver(const vector<Group> &groups, const vector<uint64_t> &groupOutputs, const vector<vector<uint64_t>> &targets, uint64_t cellCount, CoverBudget budget, WorkPool *pool = nullptr) {
+        this->budget = budget;
+        this->pool = pool;
+        //Target cells are numbered in order, output by output, so the row of a cell is the count of target cells before it
+        //Counts are kept per word rather than per cell, so the table is a fraction of the size of the targets themselves
+        uint64_t wordCount = (cellCount + 63) / 64;
+        vector<vector<int>> rowsBefore(targets.size(), vector<int>(wordCount));
+        int rowCount = 0;
+        for (int output = 0; output < targets.size(); output++) {
+            for (uint64_t word = 0; word < wordCount; word++) {
+                rowsBefore[output][word] = rowCount;
+                rowCount += popcount64(targets[output][word]);
+            }
+        }
+        rowColumns.assign(rowCount, vector<int>());
+        columnRows.assign(groups.size(), vector<int>());
+        for (int column = 0; column < groups.size(); column++) {
+            for (int output = 0; output < targets.size(); output++) {
+                if (((groupOutputs[column] >> output) & 1) == 0) {
+                    continue;
+                }
+                const vector<uint64_t> &outputTargets = targets[output];
+                groups[column].forEachWord([&](uint64_t word, uint64_t bits) {
+                    uint64_t covered = outputTargets[word] & bits;
+                    while (covered != 0) {
+                        uint64_t low = covered & (~covered + 1);
+                        int row = rowsBefore[output][word] + popcount64(outputTargets[word] & (low - 1));
+                        columnRows[column].push_back(row);
+                        rowColumns[row].push_back(column);
+                        covered ^= low;
+                    }
+                });
+            }
+            sort(columnRows[column].begin(), columnRows[column].end());
+        }
+        rowActive.assign(rowCount, 1);
+        columnActive.assign(groups.size(), 1);
+    }
+
+    //Indices of the chosen groups, in ascending order
+    void setStats(SolveStats *stats) {
+        this->stats = stats;
+    }
+    vector<int> solve() {
+        start = chrono::steady_clock::now();
+        {
+            STATS_PHASE(stats, "cover_reduce");
+            bool changed = true;
+            while (changed) {
+                changed = takeEssentials();
+                changed = removeDominatedRows() || changed;
+                changed = removeDominatedColumns() || changed;
+            }
+            buildCore();
+        }
+        STATS_COUNT(stats, "essential_groups", chosen.size());
+        STATS_COUNT(stats, "core_rows", coreRowColumns.size());
+        STATS_COUNT(stats, "core_columns", coreColumns.size());
+        if (!coreColumns.empty()) {
+            STATS_PHASE(stats, "cover_search");
+            CoverNode root;
+            root.uncovered.assign((coreRowColumns.size() + 63) / 64, 0);
+            for (int row = 0; row < coreRowColumns.size(); row++) {
+                setBit(root.uncovered, row);
+            }
+            root.excluded.assign((coreColumns.size() + 63) / 64, 0);
+            greedyCover(root.uncovered);
+            search(root);
+            exact = !stopped;
+            for (int column : best) {
+                chosen.push_back(coreColumns[column]);
+            }
+        }
+        STATS_COUNT(stats, "cover_nodes", nodes);
+        STATS_COUNT(stats, "cover_stopped", stopped ? 1 : 0);
+        sort(chosen.begin(), chosen.end());
+        return chosen;
+    }
+};
+
+//Keeps the fewest groups that still cover every target cell
+//timedOut, if given, is set to whether the search was cut short by budget.maxSeconds
+vector<Group> minimumCover(const vector<Group> &groups, const vector<uint64_t> &targets, uint64_t cellCount, CoverBudget budget = CoverBudget(), WorkPool *pool = nullptr, SolveStats *stats = nullptr, bool *timedOut = nullptr) {
+    vector<Group> result;
+    CoverSolver solver(groups, targets, cellCount, budget, pool);
+    solver.setStats(stats);
+    for (int column : solver.solve()) {
+        result.push_back(groups[column]);
+    }
+    if (timedOut != nullptr) {
+        *timedOut = solver.timedOut;
+    }
+    return result;
+}
+//Exact minimum cover code above
+
+//Multiple output code below
+//Functions of the same inputs are minimized together so that a product needed by several of them is only counted once
+//The primes are cubes with the outputs they are implicants of, found by one pass of the Quine-McCluskey merging
+//The fewest primes covering every output's targets are chosen, then each output keeps the fewest of those that cover it
+
+//targets[i] and dontCares[i] are the packed tables of output i, at most 64 outputs
+//Returns the groups covering each output, a product shared by several outputs is the same group in each of their covers
+//pool runs the merging and the cover reductions, nullptr meaning the calling thread alone
+vector<vector<Group>> multipleOutputCover(const vector<vector<uint64_t>> &targets, const vector<vector<uint64_t>> &dontCares, int varCount, CoverBudget budget = CoverBudget(), WorkPool *pool = nullptr) {
+    uint64_t cellCount = 1ull << varCount;
+    WorkPool serial(1);
+    PrimeGenerator generator(targets, dontCares, varCount, pool ? *pool : serial);
+    const vector<Group> &primes = generator.getPrimes();
+    const vector<uint64_t> &primeOutputs = generator.getPrimeOutputs();
+    vector<Group> shared;
+    vector<uint64_t> sharedOutputs;
+    for (int column : CoverSolver(primes, primeOutputs, targets, cellCount, budget, pool).solve()) {
+        shared.push_back(primes[column]);
+        sharedOutputs.push_back(primeOutputs[column]);
+    }
+    //A prime is an implicant of every output in its mask, but may not be needed by all of them
+    vector<vector<Group>> covers;
+    for (int output = 0; output < targets.size(); output++) {
+        vector<Group> candidates;
+        for (int x = 0; x < shared.size(); x++) {
+            if ((sharedOutputs[x] >> output) & 1) {
+                candidates.push_back(shared[x]);
+            }
+        }
+        covers.push_back(minimumCover(candidates, targets[output], cellCount, budget, pool));
+    }
+    return covers;
+}
+//Multiple output code above
+
+//Espresso heuristic minimizer code below
+//Works on covers, lists of cubes whose union is a function, so functions of up to 64 variables never need a truth table
+//The cover is expanded, made irredundant and reduced, over and over until it stops shrinking
+//Every step is answered by tautology checks on cofactors of the covers, so the OFF-set, which may be huge, is never built
+//The result is a small cover of prime implicants, but unlike QUINE_MCCLUSKEY it is not guaranteed to be the smallest
+typedef vector<Group> Cover;
+
+//Mask of the bits used by varCount variables
+uint64_t variableBits(int varCount) {
+    return varCount == 64 ? ~0ull : (1ull << varCount) - 1;
+}
+
+bool intersects(const Group &a, const Group &b) {
+    return ((a.value ^ b.value) & ~a.mask & ~b.mask) == 0;
+}
+
+//Checks whether every cell of inner is in outer
+bool contains(const Group &outer, const Group &inner) {
+    return (inner.mask & ~outer.mask) == 0 && ((outer.value ^ inner.value) & ~outer.mask) == 0;
+}
+
+//Adds cubes covering the cells set in bits between first and first + 2^freeBits
+//Ranges that are all set become one cube, mixed ranges are split in half on their most significant free variable
+void addRangeCubes(const vector<uint64_t> &bits, uint64_t first, int freeBits, Cover &cover) {
+    uint64_t count = 1ull << freeBits;
+    bool any = false;
+    bool all = true;
+    if (count >= 64) {
+        for (uint64_t word = first / 64; word < (first + count) / 64; word++) {
+            any = any || bits[word] != 0;
+            all = all && bits[word] == ~0ull;
+        }
+    }
+    else {
+        uint64_t range = (bits[first / 64] >> (first % 64)) & ((1ull << count) - 1);
+        any = range != 0;
+        all = range == (1ull << count) - 1;
+    }
+    if (all) {
+        cover.push_back(Group(first, count - 1));
+    }
+    else if (any) {
+        addRangeCubes(bits, first, freeBits - 1, cover);
+        addRangeCubes(bits, first + count / 2, freeBits - 1, cover);
+    }
+}
+
+//Disjoint cover of the cells set in a packed table
+Cover tableCover(const vector<uint64_t> &bits, int varCount) {
+    Cover cover;
+    addRangeCubes(bits, 0, varCount, cover);
+    return cover;
+}
+
+//Packed table of the cells in a cover, the reverse of tableCover
+vector<uint64_t> coverTable(const Cover &cover, int varCount) {
+    vector<uint64_t> bits(((1ull << varCount) + 63) / 64);
+    for (const Group &cube : cover) {
+        cube.forEachWord([&](uint64_t word, uint64_t pattern) {bits[word] |= pattern;});
+    }
+    return bits;
+}
+
+//Number of cubes covering each cell, stored bit sliced: plane k holds bit k of every cell's count, 64 cells per word
+//Adding or removing a cube ripples a carry through the planes over the words the cube meets,
+//and the cells covered at all and covered more than once are kept beside the planes,
+//so the cells only one cube covers are found with an AND a word rather than a count a cell
+class CoverCounts {
+    vector<vector<uint64_t>> planes;
+    vector<uint64_t> any;//Cells covered at least once
+    vector<uint64_t> many;//Cells covered at least twice
+    vector<uint64_t> within;//Cells counted
+
+    public:
+    CoverCounts() {}
+    //Counts only the cells set in within
+    CoverCounts(const vector<uint64_t> &within) {
+        this->within = within;
+        any.assign(within.size(), 0);
+        many = any;
+    }
+    void add(const Group &cube) {
+        cube.forEachWord([this](uint64_t word, uint64_t bits) {
+            uint64_t carry = bits & within[word];
+            many[word] |= any[word] & carry;
+            any[word] |= carry;
+            for (int plane = 0; carry != 0; plane++) {
+                if (plane == planes.size()) {
+                    planes.push_back(vector<uint64_t>(any.size(), 0));
+                }
+                uint64_t next = planes[plane][word] & carry;
+                planes[plane][word] ^= carry;
+                carry = next;
+            }
+        });
+    }
+    void remove(const Group &cube) {
+        cube.forEachWord([this](uint64_t word, uint64_t bits) {
+            uint64_t borrow = bits & within[word];
+            if (borrow == 0) {
+                return;
+            }
+            for (int plane = 0; borrow != 0; plane++) {
+                uint64_t next = ~planes[plane][word] & borrow;
+                planes[plane][word] ^= borrow;
+                borrow = next;
+            }
+            uint64_t more = 0;
+            for (int plane = 1; plane < planes.size(); plane++) {
+                more |= planes[plane][word];
+            }
+            many[word] = more;
+            any[word] = more | planes[0][word];
+        });
+    }
+    //Cells of a word covered exactly once
+    uint64_t once(uint64_t word) const {
+        return any[word] & ~many[word];
+    }
+    //Whether some cell of a cube is covered by it alone
+    bool coversOnce(const Group &cube) const {
+        bool found = false;
+        cube.forEachWord([&](uint64_t word, uint64_t bits) {found = found || (once(word) & bits) != 0;});
+        return found;
+    }
+};
+
+class Espresso {
+    uint64_t varBits;
+    Cover onSet;
+    Cover dcSet;
+    Cover careSet;//ON-set and DC-set together, which every cube of the cover must stay inside
+    vector<uint64_t> careTable;//The care set packed 64 cells per word, if the function came from a truth table
+    vector<uint64_t> onTable;//The ON-set packed 64 cells per word, if the function came from a truth table
+    CoverCounts coverCounts;//Number of cubes covering each ON cell, zero for every other cell
+
+    //Cubes of a cover that meet the half of the space where the variable at bit equals value, with that variable freed
+    Cover cofactor(const Cover &cover, uint64_t bit, bool value) {
+        Cover result;
+        for (const Group &cube : cover) {
+            if ((cube.mask & bit) || ((cube.value & bit) != 0) == value) {
+                result.push_back(Group(cube.value & ~bit, cube.mask | bit));
+            }
+        }
+        return result;
+    }
+    //Cubes of a cover that meet a cube, with the cube's fixed variables freed
+    Cover cofactor(const Cover &cover, const Group &cube) {
+        Cover result;
+        uint64_t fixed = ~cube.mask & varBits;
+        for (const Group &other : cover) {
+            if (intersects(other, cube)) {
+                result.push_back(Group(other.value & ~fixed, other.mask | fixed));
+            }
+        }
+        return result;
+    }
+    //Cofactor of the DC-set and the kept cubes of a cover other than cover[skip], against cover[skip]
+    Cover cofactorOthers(const Cover &cover, const vector<char> &kept, int skip) {
+        Cover result = cofactor(dcSet, cover[skip]);
+        uint64_t fixed = ~cover[skip].mask & varBits;
+        for (int x = 0; x < cover.size(); x++) {
+            if (x != skip && kept[x] && intersects(cover[x], cover[skip])) {
+                result.push_back(Group(cover[x].value & ~fixed, cover[x].mask | fixed));
+            }
+        }
+        return result;
+    }
+    //Variable fixed in the most cubes among the candidate bits
+    uint64_t mostUsed(const Cover &cover, uint64_t candidates) {
+        uint64_t best = candidates & (~candidates + 1);
+        int bestCount = -1;
+        for (uint64_t bits = candidates; bits != 0; bits &= bits - 1) {
+            uint64_t bit = bits & (~bits + 1);
+            int count = 0;
+            for (const Group &cube : cover) {
+                count += (cube.mask & bit) == 0;
+            }
+            if (count > bestCount) {
+                best = bit;
+                bestCount = count;
+            }
+        }
+        return best;
+    }
+    //Finds the variables that appear as a plain and as a negated literal, or returns false if the cover holds the universal cube
+    bool literalUse(const Cover &cover, uint64_t &plain, uint64_t &negated) {
+        plain = 0;
+        negated = 0;
+        for (const Group &cube : cover) {
+            uint64_t fixed = ~cube.mask & varBits;
+            if (fixed == 0) {
+                return false;
+            }
+            plain |= cube.value & fixed;
+            negated |= ~cube.value & fixed;
+        }
+        return true;
+    }
+    //Checks whether a cover contains every cell
+    bool tautology(const Cover &cover) {
+        uint64_t plain;
+        uint64_t negated;
+        if (cover.empty()) {
+            return false;
+        }
+        if (!literalUse(cover, plain, negated)) {
+            return true;
+        }
+        //A cover in which no variable appears both ways is only a tautology if it holds the universal cube
+        if ((plain & negated) == 0) {
+            return false;
+        }
+        uint64_t bit = mostUsed(cover, plain & negated);
+        return tautology(cofactor(cover, bit, 0)) && tautology(cofactor(cover, bit, 1));
+    }
+    //Smallest cube containing every cell not in a cover, which is all reduce needs, without building the complement itself
+    //Returns false if the cover contains every cell
+    bool complementSupercube(const Cover &cover, Group &super) {
+        uint64_t plain;
+        uint64_t negated;
+        if (cover.empty()) {
+            super = Group(0, varBits);
+            return true;
+        }
+        if (!literalUse(cover, plain, negated)) {
+            return false;
+        }
+        if (cover.size() == 1) {
+            //By De Morgan the complement of a cube is the union of its negated literals, which only leaves a literal fixed if there is one
+            uint64_t fixed = ~cover[0].mask & varBits;
+            super = popcount64(fixed) == 1 ? Group(~cover[0].value & fixed, varBits & ~fixed) : Group(0, varBits);
+            return true;
+        }
+        uint64_t bit = mostUsed(cover, (plain & negated) ? plain & negated : plain | negated);
+        Group low(0, 0);
+        Group high(0, 0);
+        bool hasLow = complementSupercube(cofactor(cover, bit, 0), low);
+        bool hasHigh = complementSupercube(cofactor(cover, bit, 1), high);
+        low = Group(low.value & ~bit, low.mask & ~bit);
+        high = Group(high.value | bit, high.mask & ~bit);
+        if (!hasLow || !hasHigh) {
+            super = hasLow ? low : high;
+            return hasLow || hasHigh;
+        }
+        uint64_t mask = low.mask | high.mask | (low.value ^ high.value);
+        super = Group(low.value & ~mask, mask);
+        return true;
+    }
+    //Checks whether every cell of a cube is in the ON-set or DC-set
+    //Small cubes of a function with a truth table are checked cell by cell, which beats scanning the care set
+    bool inCareSet(const Group &cube) {
+        if (!careTable.empty() && cube.size() <= 64) {
+            bool inside = true;
+            cube.forEach([&](uint64_t cell) {
+                inside = inside && ((careTable[cell / 64] >> (cell % 64)) & 1);
+            });
+            return inside;
+        }
+        return tautology(cofactor(careSet, cube));
+    }
+
+    //Grows every cube as far as the care set allows, dropping cubes swallowed by a grown cube
+    //Larger cubes go first, and variables freed in many cubes are raised first, so grown cubes tend to swallow more
+    Cover expand(Cover cover) {
+        stable_sort(cover.begin(), cover.end(), [](const Group &a, const Group &b) {
+            return a.size() > b.size();
+        });
+        vector<pair<int, uint64_t>> order;
+        for (uint64_t bits = varBits; bits != 0; bits &= bits - 1) {
+            uint64_t bit = bits & (~bits + 1);
+            int freeCount = 0;
+            for (const Group &cube : cover) {
+                freeCount += (cube.mask & bit) != 0;
+            }
+            order.push_back(make_pair(-freeCount, bit));
+        }
+        stable_sort(order.begin(), order.end(), [](const pair<int, uint64_t> &a, const pair<int, uint64_t> &b) {
+            return a.first < b.first;
+        });
+        Cover result;
+        vector<char> covered(cover.size(), 0);
+        for (int x = 0; x < cover.size(); x++) {
+            if (covered[x]) {
+                continue;
+            }
+            Group cube = cover[x];
+            for (const pair<int, uint64_t> &literal : order) {
+                if (!(cube.mask & literal.second) && inCareSet(cube.extend(literal.second))) {
+                    cube = cube.extend(literal.second);
+                }
+            }
+            for (int y = x + 1; y < cover.size(); y++) {
+                covered[y] = covered[y] || contains(cube, cover[y]);
+            }
+            result.push_back(cube);
+        }
+        return result;
+    }
+    //Drops cubes whose cells are all covered by the rest of the cover and the DC-set, smallest first
+    Cover irredundant(const Cover &cover) {
+        vector<int> order(cover.size());
+        for (int x = 0; x < order.size(); x++) {
+            order[x] = x;
+        }
+        stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return cover[a].size() < cover[b].size();
+        });
+        vector<char> kept(cover.size(), 1);
+        if (!onTable.empty()) {
+            //With a truth table a cube is redundant when every ON cell in it is covered by another cube
+            countCover(cover);
+            for (int x : order) {
+                if (!coverCounts.coversOnce(cover[x])) {
+                    kept[x] = 0;
+                    uncount(cover[x]);
+                }
+            }
+        }
+        else {
+            for (int x : order) {
+                kept[x] = !tautology(cofactorOthers(cover, kept, x));
+            }
+        }
+        Cover result;
+        for (int x = 0; x < cover.size(); x++) {
+            if (kept[x]) {
+                result.push_back(cover[x]);
+            }
+        }
+        return result;
+    }
+    //Shrinks every cube to the smallest cube holding the cells only it covers, so the next expand can grow it another way
+    Cover reduce(Cover cover) {
+        stable_sort(cover.begin(), cover.end(), [](const Group &a, const Group &b) {
+            return a.size() > b.size();
+        });
+        vector<char> kept(cover.size(), 1);
+        if (!onTable.empty()) {
+            //With a truth table the cells only a cube covers are its ON cells counted once
+            countCover(cover);
+        }
+        for (int x = 0; x < cover.size(); x++) {
+            Group super(0, 0);
+            if (!onTable.empty()) {
+                kept[x] = countedOnce(cover[x], super);
+                uncount(cover[x]);
+                if (kept[x]) {
+                    cover[x] = super;
+                    recount(super);
+                }
+                continue;
+            }
+            if (!complementSupercube(cofactorOthers(cover, kept, x), super)) {
+                kept[x] = 0;
+                continue;
+            }
+            //The cofactor leaves the cube's own variables free, so the supercube only narrows the free ones
+            cover[x] = Group(cover[x].value | (super.value & cover[x].mask), cover[x].mask & super.mask);
+        }
+        Cover result;
+        for (int x = 0; x < cover.size(); x++) {
+            if (kept[x]) {
+                result.push_back(cover[x]);
+            }
+        }
+        return result;
+    }
+    //Counts the cubes of a cover holding each ON cell of a truth table
+    void countCover(const Cover &cover) {
+        coverCounts = CoverCounts(onTable);
+        for (const Group &cube : cover) {
+            recount(cube);
+        }
+    }
+    void recount(const Group &cube) {
+        coverCounts.add(cube);
+    }
+    void uncount(const Group &cube) {
+        coverCounts.remove(cube);
+    }
+    //Finds the smallest cube holding the ON cells of a cube that no other cube covers, or returns false if there are none
+    bool countedOnce(const Group &cube, Group &super) {
+        bool found = false;
+        cube.forEachWord([&](uint64_t word, uint64_t bits) {
+            for (uint64_t once = coverCounts.once(word) & bits; once != 0; once &= once - 1) {
+                uint64_t cell = word * 64 + popcount64((once & (~once + 1)) - 1);
+                uint64_t mask = found ? super.mask | (super.value ^ cell) : 0;
+                super = Group(cell & ~mask, mask);
+                found = true;
+            }
+        });
+        return found;
+    }
+    //Covers are compared by number of cubes, then by number of literals
+    pair<uint64_t, uint64_t> cost(const Cover &cover) {
+        uint64_t literals = 0;
+        for (const Group &cube : cover) {
+            literals += popcount64(~cube.mask & varBits);
+        }
+        return make_pair((uint64_t) cover.size(), literals);
+    }
+
+    public:
+    Espresso(const Cover &onSet, const Cover &dcSet, int varCount) {
+        this->varBits = variableBits(varCount);
+        this->onSet = onSet;
+        this->dcSet = dcSet;
+        careSet = onSet;
+        careSet.insert(careSet.end(), dcSet.begin(), dcSet.end());
+    }
+    //Minimizes the function of a truth table, given its ON-set and DC-set packed 64 cells per word
+    Espresso(const vector<uint64_t> &onTable, const vector<uint64_t> &dcTable, int varCount) : Espresso(tableCover(onTable, varCount), tableCover(dcTable, varCount), varCount) {
+        this->onTable = onTable;
+        careTable.resize(onTable.size());
+        for (uint64_t x = 0; x < careTable.size(); x++) {
+            careTable[x] = onTable[x] | dcTable[x];
+        }
+    }
+    Cover minimize() {
+        Cover cover = irredundant(expand(onSet));
+        while (!cover.empty()) {
+            Cover next = irredundant(expand(reduce(cover)));
+            if (!(cost(next) < cost(cover))) {
+                break;
+            }
+            cover.swap(next);
+        }
+        return cover;
+    }
+};
+
+//Minimizes the function covered by onSet, with dcSet left free, without building its truth table
+Cover espresso(const Cover &onSet, const Cover &dcSet, int varCount) {
+    return Espresso(onSet, dcSet, varCount).minimize();
+}
+//Espresso heuristic minimizer code above
+
+//Incremental repair code below
+//When a few cells of a minimized function change, its cover is repaired rather than the function minimized again
+//Cubes still inside the care set are kept and those next to a changed cell grow as far as the new care set allows,
+//cubes reaching a cell that left the care set are dropped, and only the target cells this leaves uncovered grow into new primes,
+//of which the fewest covering them are chosen, before the cubes near the change that became redundant are dropped
+//Each step keeps every cube inside the care set and every target cell covered, so the result is always a valid cover,
+//though it is only as small as the old cover around the changed cells allows
+
+//Cubes of cells added to and removed from the ON-set and DC-set of a function
+//Removals apply before additions, and a cell ending up in both sets is a don't care
+struct TableDelta {
+    Cover addOn;
+    Cover removeOn;
+    Cover addDontCare;
+    Cover removeDontCare;
+};
+
+//Whether every cell of a cube is set in a packed table
+bool tableContains(const vector<uint64_t> &table, const Group &cube) {
+    bool inside = true;
+    cube.forEachWord([&](uint64_t word, uint64_t bits) {inside = inside && (table[word] & bits) == bits;});
+    return inside;
+}
+//Number of cells of a cube set in a packed table
+uint64_t tableCount(const vector<uint64_t> &table, const Group &cube) {
+    uint64_t count = 0;
+    cube.forEachWord([&](uint64_t word, uint64_t bits) {count += popcount64(table[word] & bits);});
+    return count;
+}
+
+//Raises one variable of a cube at a time while it stays inside care, choosing the variable whose raising reaches the most uncovered cells
+Group growCube(Group cube, const vector<uint64_t> &care, const vector<uint64_t> &uncovered, int varCount) {
+    while (true) {
+        uint64_t bestBit = 0;
+        uint64_t bestCount = 0;
+        for (int y = 0; y < varCount; y++) {
+            uint64_t bit = 1ull << y;
+            //Raising a variable adds the cube's mirror image across it
+            Group mirror(cube.value ^ bit, cube.mask);
+            if ((cube.mask & bit) || !tableContains(care, mirror)) {
+                continue;
+            }
+            uint64_t count = tableCount(uncovered, mirror);
+            if (bestBit == 0 || count > bestCount) {
+                bestBit = bit;
+                bestCount = count;
+            }
+        }
+        if (bestBit == 0) {
+            return cube;
+        }
+        cube = cube.extend(bestBit);
+    }
+}
+
+//Repairs a cover of targets, with dontCares left free, after the cells set in changed took new values
+//targets and dontCares are the new tables, and pool runs the cover of the uncovered cells, nullptr meaning the calling thread alone
+vector<Group> repairCover(const vector<Group> &cover, const vector<uint64_t> &targets, const vector<uint64_t> &dontCares, const vector<uint64_t> &changed, int varCount, CoverBudget budget = CoverBudget(), WorkPool *pool = nullptr) {
+    vector<uint64_t> care(targets.size());
+    for (uint64_t x = 0; x < care.size(); x++) {
+        care[x] = targets[x] | dontCares[x];
+    }
+    //A cube is near the change if a changed cell is in it or in its mirror image across one of its variables
+    auto nearChange = [&](const Group &cube) {
+        bool near = tableCount(changed, cube) != 0;
+        for (int y = 0; y < varCount && !near; y++) {
+            uint64_t bit = 1ull << y;
+            near = !(cube.mask & bit) && tableCount(changed, Group(cube.value ^ bit, cube.mask)) != 0;
+        }
+        return near;
+    };
+    Cover kept;
+    vector<char> near;
+    for (const Group &cube : cover) {
+        if (tableContains(care, cube)) {
+            kept.push_back(cube);
+            near.push_back(nearChange(cube));
+        }
+    }
+    vector<uint64_t> uncovered = coverTable(kept, varCount);
+    for (uint64_t x = 0; x < uncovered.size(); x++) {
+        uncovered[x] = targets[x] & ~uncovered[x];
+    }
+    for (int x = 0; x < kept.size(); x++) {
+        if (near[x]) {
+            kept[x] = growCube(kept[x], care, uncovered, varCount);
+            kept[x].forEachWord([&](uint64_t word, uint64_t bits) {uncovered[word] &= ~bits;});
+        }
+    }
+    //Each uncovered cell not reached by an earlier new prime grows into one
+    Cover candidates;
+    vector<uint64_t> reached(uncovered.size(), 0);
+    for (uint64_t word = 0; word < uncovered.size(); word++) {
+        while ((uncovered[word] & ~reached[word]) != 0) {
+            uint64_t bits = uncovered[word] & ~reached[word];
+            uint64_t cell = word * 64 + popcount64((bits & (~bits + 1)) - 1);
+            Group prime = growCube(Group(cell, 0), care, uncovered, varCount);
+            prime.forEachWord([&](uint64_t word, uint64_t bits) {reached[word] |= bits;});
+            candidates.push_back(prime);
+        }
+    }
+    Cover result = kept;
+    vector<char> affected = near;
+    if (!candidates.empty()) {
+        for (const Group &prime : minimumCover(candidates, uncovered, 1ull << varCount, budget, pool)) {
+            result.push_back(prime);
+            affected.push_back(1);
+        }
+    }
+    //Cubes near the change, smallest first, are dropped while every target cell in them is covered by another cube
+    CoverCounts counts(targets);
+    for (const Group &cube : result) {
+        counts.add(cube);
+    }
+    vector<int> order;
+    for (int x = 0; x < result.size(); x++) {
+        if (affected[x]) {
+            order.push_back(x);
+        }
+    }
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return result[a].size() < result[b].size();
+    });
+    vector<char> dropped(result.size(), 0);
+    for (int x : order) {
+        if (!counts.coversOnce(result[x])) {
+            counts.remove(result[x]);
+            dropped[x] = 1;
+        }
+    }
+    Cover repaired;
+    for (int x = 0; x < result.size(); x++) {
+        if (!dropped[x]) {
+            repaired.push_back(result[x]);
+        }
+    }
+    return repaired;
+}
+//Incremental repair code above
+
+//Result cache code below
+//Minimized functions are kept on disk, so a later run or another process skips minimizing a function it has seen
+//A cache is a directory of two files: "log", an append-only list of records each holding a key and the groups chosen for it,
+//and "index", a table of fixed slots memory-mapped by every process, holding the hash, log position and last use of each record
+//Every lookup and insert holds a lock on the index, so any number of processes may share a cache
+//When the log would pass its size limit it is rewritten with the most recently used records that fit in half the limit
+//Words are stored in the machine's own byte order, which the index header records so a cache from another kind of machine starts over
+//Covers whose search was cut short by --max-seconds are not stored, since a later run could do better with the same key
+//On systems without mmap and flock the cache never opens and every lookup misses
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HAS_RESULT_CACHE_FILES
+#endif
+
+//Identifies a minimization: the packed planes of each function and the settings that pick its groups
+struct FunctionKey {
+    int varCount;
+    int solver;//Solver used, or -1 for functions simplified together
+    CoverBudget budget;
+    vector<uint64_t> planes;//ON plane then DC plane of each function
+    uint64_t hash = 0;
+    FunctionKey(int varCount, int solver, CoverBudget budget) {
+        this->varCount = varCount;
+        this->solver = solver;
+        this->budget = budget;
+    }
+    void addFunction(const vector<uint64_t> &on, const vector<uint64_t> &dontCare) {
+        planes.insert(planes.end(), on.begin(), on.end());
+        planes.insert(planes.end(), dontCare.begin(), dontCare.end());
+    }
+    //Hashes the key once all of its functions are added, giving the same hash in every run
+    void finish() {
+        uint64_t mixed = ((uint64_t) varCount << 32) ^ (uint32_t) solver ^ (budget.maxNodes * 0x9E3779B97F4A7C15ull);
+        for (uint64_t word : planes) {
+            mixed = (mixed ^ word) * 0xBF58476D1CE4E5B9ull;
+            mixed ^= mixed >> 31;
+        }
+        hash = mixed;
+    }
+    bool operator==(const FunctionKey &other) const {
+        return hash == other.hash && varCount == other.varCount && solver == other.solver && budget.maxNodes == other.budget.maxNodes
+            && budget.maxSeconds == other.budget.maxSeconds && planes == other.planes;
+    }
+    //The key as stored in a record
+    string bytes() const {
+        string result;
+        appendWord(result, varCount);
+        appendWord(result, (uint32_t) solver);
+        appendWord(result, budget.maxNodes);
+        uint64_t seconds;
+        memcpy(&seconds, &budget.maxSeconds, sizeof(seconds));
+        appendWord(result, seconds);
+        for (uint64_t word : planes) {
+            appendWord(result, word);
+        }
+        return result;
+    }
+    static void appendWord(string &bytes, uint64_t word) {
+        bytes.append((const char *) &word, sizeof(word));
+    }
+};
+
+struct FunctionKeyHash {
+    size_t operator()(const FunctionKey &key) const {
+        return key.hash;
+    }
+};
+
+#ifdef HAS_RESULT_CACHE_FILES
+class ResultCache {
+    struct Header {
+        uint64_t magic;
+        uint64_t byteOrder;//The byteOrder constant as the writing machine stores it, so a machine of the other byte order reads another value
+        uint64_t version;
+        uint64_t slotCount;
+        uint64_t generation;//Counts rewrites of the log, telling other processes to reopen it
+        uint64_t logBytes;//Bytes of the log holding whole records, anything after them is an unfinished write
+        uint64_t entryCount;
+        uint64_t clock;//Counts lookups, stamping each slot with the time of its last use
+    };
+    struct Slot {
+        uint64_t hash;//Hash of the key, 0 for an empty slot
+        uint64_t offset;//Position of the record in the log
+        uint64_t length;//Bytes of the record
+        uint64_t lastUse;
+    };
+    static const uint64_t magic = 0x314548434150414Bull;
+    static const uint64_t byteOrder = 0x0102030405060708ull;
+    static const uint64_t version = 2;//Raised whenever the layout of the index or of a record changes
+    static const uint64_t slotCount = 1 << 16;//Slots are never more than half full, since probing slows down past that
+
+    string directory;
+    uint64_t maxBytes;
+    int indexFile = -1;
+    int logFile = -1;
+    uint64_t generation = 0;//Generation of the log this process has open
+    Header *header = nullptr;
+    Slot *slots = nullptr;
+    size_t mappedBytes = 0;
+    mutex lock;//Threads of this process share one open index, which the file lock alone would not keep apart
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    //Holds both the thread and the process lock for as long as it lives
+    class Guard {
+        ResultCache &cache;
+        unique_lock<mutex> threadLock;
+        public:
+        Guard(ResultCache &cache) : cache(cache), threadLock(cache.lock) {
+            flock(cache.indexFile, LOCK_EX);
+            //Another process may have rewritten the log since this one last looked
+            if (cache.header->generation != cache.generation) {
+                close(cache.logFile);
+                cache.logFile = open((cache.directory + "/log").c_str(), O_RDWR | O_CREAT, 0666);
+                cache.generation = cache.header->generation;
+            }
+        }
+        ~Guard() {
+            flock(cache.indexFile, LOCK_UN);
+        }
+    };
+
+    static uint64_t checksum(const string &bytes) {
+        uint64_t sum = 0xCBF29CE484222325ull;
+        for (unsigned char byte : bytes) {
+            sum = (sum ^ byte) * 0x100000001B3ull;
+        }
+        return sum;
+    }
+    static uint64_t readWord(const string &bytes, uint64_t &position) {
+        uint64_t word = 0;
+        if (position + sizeof(word) <= bytes.size()) {
+            memcpy(&word, bytes.data() + position, sizeof(word));
+        }
+        position += sizeof(word);
+        return word;
+    }
+    //A record is the key's length and bytes, the groups' length and bytes, then a checksum of everything before it
+    static string makeRecord(const string &keyBytes, const vector<vector<Group>> &covers) {
+        string value;
+        FunctionKey::appendWord(value, covers.size());
+        for (const vector<Group> &cover : covers) {
+            FunctionKey::appendWord(value, cover.size());
+            for (const Group &group : cover) {
+                FunctionKey::appendWord(value, group.value);
+                FunctionKey::appendWord(value, group.mask);
+            }
+        }
+        string record;
+        FunctionKey::appendWord(record, keyBytes.size());
+        record += keyBytes;
+        FunctionKey::appendWord(record, value.size());
+        record += value;
+        FunctionKey::appendWord(record, checksum(record));
+        return record;
+    }
+    string readRecord(const Slot &slot) {
+        string record(slot.length, '\0');
+        if (pread(logFile, &record[0], slot.length, slot.offset) != (ssize_t) slot.length) {
+            return "";
+        }
+        return record;
+    }
+    //Reads the groups out of a record, failing if the record is damaged or holds another key
+    static bool parseRecord(const string &record, const string &keyBytes, vector<vector<Group>> &covers) {
+        if (record.size() < 3 * sizeof(uint64_t)) {
+            return false;
+        }
+        uint64_t position = record.size() - sizeof(uint64_t);
+        if (readWord(record, position) != checksum(record.substr(0, record.size() - sizeof(uint64_t)))) {
+            return false;
+        }
+        position = 0;
+        uint64_t keyLength = readWord(record, position);
+        if (keyLength != keyBytes.size() || record.compare(position, keyLength, keyBytes) != 0) {
+            return false;
+        }
+        position += keyLength + sizeof(uint64_t);
+        covers.assign(readWord(record, position), vector<Group>());
+        for (vector<Group> &cover : covers) {
+            uint64_t groupCount = readWord(record, position);
+            for (uint64_t x = 0; x < groupCount && position < record.size(); x++) {
+                uint64_t value = readWord(record, position);
+                uint64_t mask = readWord(record, position);
+                cover.push_back(Group(value, mask));
+            }
+        }
+        return position + sizeof(uint64_t) == record.size();
+    }
+    //Returns the slot of a hash, either holding a record whose key matches or the empty slot where it belongs
+    Slot &findSlot(uint64_t hash, const string &keyBytes, vector<vector<Group>> &covers, bool &found) {
+        found = false;
+        uint64_t x = hash % slotCount;
+        while (slots[x].hash != 0) {
+            if (slots[x].hash == hash && parseRecord(readRecord(slots[x]), keyBytes, covers)) {
+                found = true;
+                break;
+            }
+            x = (x + 1) % slotCount;
+        }
+        return slots[x];
+    }
+    void placeSlot(const Slot &slot) {
+        uint64_t x = slot.hash % slotCount;
+        while (slots[x].hash != 0) {
+            x = (x + 1) % slotCount;
+        }
+        slots[x] = slot;
+    }
+    //Rewrites the log with the most recently used records that fit in keepBytes, dropping the rest
+    void evict(uint64_t keepBytes) {
+        vector<Slot> kept;
+        for (uint64_t x = 0; x < slotCount; x++) {
+            if (slots[x].hash != 0) {
+                kept.push_back(slots[x]);
+            }
+        }
+        sort(kept.begin(), kept.end(), [](const Slot &a, const Slot &b) {return a.lastUse > b.lastUse;});
+        string newPath = directory + "/log.new";
+        int newLog = open(newPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+        if (newLog < 0) {
+            return;
+        }
+        uint64_t bytes = 0;
+        uint64_t count = 0;
+        for (Slot &slot : kept) {
+            string record = readRecord(slot);
+            if (record.empty() || bytes + record.size() > keepBytes || count + 1 > slotCount / 4) {
+                break;
+            }
+            if (pwrite(newLog, record.data(), record.size(), bytes) != (ssize_t) record.size()) {
+                break;
+            }
+            slot.offset = bytes;
+            bytes += record.size();
+            count++;
+        }
+        kept.resize(count);
+        fsync(newLog);
+        rename(newPath.c_str(), (directory + "/log").c_str());
+        close(logFile);
+        logFile = newLog;
+        memset(slots, 0, slotCount * sizeof(Slot));
+        for (const Slot &slot : kept) {
+            placeSlot(slot);
+        }
+        header->logBytes = bytes;
+        header->entryCount = count;
+        generation = ++header->generation;
+    }
+
+    public:
+    //Opens the cache in directory, creating it if needed, with its log held under maxBytes
+    ResultCache(string directory, uint64_t maxBytes = 64ull << 20) {
+        this->directory = directory;
+        this->maxBytes = maxBytes;
+        mkdir(directory.c_str(), 0777);
+        indexFile = open((directory + "/index").c_str(), O_RDWR | O_CREAT, 0666);
+        if (indexFile < 0) {
+            return;
+        }
+        flock(indexFile, LOCK_EX);
+        mappedBytes = sizeof(Header) + slotCount * sizeof(Slot);
+        struct stat status;
+        bool fresh = fstat(indexFile, &status) != 0 || (uint64_t) status.st_size != mappedBytes;
+        if (fresh && ftruncate(indexFile, mappedBytes) != 0) {
+            flock(indexFile, LOCK_UN);
+            close(indexFile);
+            indexFile = -1;
+            return;
+        }
+        void *mapped = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, indexFile, 0);
+        if (mapped == MAP_FAILED) {
+            flock(indexFile, LOCK_UN);
+            close(indexFile);
+            indexFile = -1;
+            return;
+        }
+        header = (Header *) mapped;
+        slots = (Slot *) (header + 1);
+        logFile = open((directory + "/log").c_str(), O_RDWR | O_CREAT, 0666);
+        //A new or unreadable index, or one written by another version or a machine of the other byte order, starts the cache over
+        if (fresh || header->magic != magic || header->byteOrder != byteOrder || header->version != version || header->slotCount != slotCount) {
+            memset(mapped, 0, mappedBytes);
+            header->magic = magic;
+            header->byteOrder = byteOrder;
+            header->version = version;
+            header->slotCount = slotCount;
+            if (ftruncate(logFile, 0) != 0) {
+                header->magic = 0;
+            }
+        }
+        generation = header->generation;
+        flock(indexFile, LOCK_UN);
+    }
+    ~ResultCache() {
+        if (header != nullptr) {
+            munmap(header, mappedBytes);
+        }
+        if (logFile >= 0) {
+            close(logFile);
+        }
+        if (indexFile >= 0) {
+            close(indexFile);
+        }
+    }
+    bool isOpen() {
+        return header != nullptr && logFile >= 0;
+    }
+    //Fills covers with the groups stored for key, returning whether there were any
+    bool find(const FunctionKey &key, vector<vector<Group>> &covers) {
+        if (!isOpen()) {
+            return false;
+        }
+        Guard guard(*this);
+        bool found;
+        Slot &slot = findSlot(key.hash | (key.hash == 0), key.bytes(), covers, found);
+        if (found) {
+            slot.lastUse = ++header->clock;
+            hits++;
+        }
+        else {
+            misses++;
+        }
+        return found;
+    }
+    void insert(const FunctionKey &key, const vector<vector<Group>> &covers) {
+        if (!isOpen()) {
+            return;
+        }
+        Guard guard(*this);
+        uint64_t hash = key.hash | (key.hash == 0);
+        string keyBytes = key.bytes();
+        string record = makeRecord(keyBytes, covers);
+        if (record.size() > maxBytes / 2) {
+            return;
+        }
+        vector<vector<Group>> stored;
+        bool found;
+        findSlot(hash, keyBytes, stored, found);
+        //Another process may have stored the same key first
+        if (found) {
+            return;
+        }
+        if (header->logBytes + record.size() > maxBytes || header->entryCount + 1 > slotCount / 2) {
+            evict(maxBytes / 2 - record.size());
+            if (header->entryCount + 1 > slotCount / 2) {
+                return;
+            }
+        }
+        if (pwrite(logFile, record.data(), record.size(), header->logBytes) != (ssize_t) record.size()) {
+            return;
+        }
+        Slot slot;
+        slot.hash = hash;
+        slot.offset = header->logBytes;
+        slot.length = record.size();
+        slot.lastUse = ++header->clock;
+        placeSlot(slot);
+        header->logBytes += record.size();
+        header->entryCount++;
+    }
+    uint64_t hitCount() {
+        return hits;
+    }
+    uint64_t missCount() {
+        return misses;
+    }
+};
+#else
+class ResultCache {
+    public:
+    ResultCache(string directory, uint64_t maxBytes = 64ull << 20) {}
+    bool isOpen() {
+        return false;
+    }
+    bool find(const FunctionKey &key, vector<vector<Group>> &covers) {
+        return false;
+    }
+    void insert(const FunctionKey &key, const vector<vector<Group>> &covers) {}
+    uint64_t hitCount() {
+        return 0;
+    }
+    uint64_t missCount() {
+        return 0;
+    }
+};
+#endif
+//Result cache code above
+
+//Ways of finding the groups for a kmap
+//GROUPING grows groups from each cell across the kmap's dimensions, QUINE_MCCLUSKEY finds every prime implicant and the fewest covering the kmap
+//ESPRESSO trades the guarantee of a minimal result for speed on large kmaps
+enum Solver {GROUPING, QUINE_MCCLUSKEY, ESPRESSO};
+
+class KarnaughMap {
+    //Cells are implicit: cell m holds output row m, so no per-cell objects or adjacency lists are kept
+    //The neighbor of a cell across variable y is found by flipping bit (varCount - 1 - y)
+    int varCount;
+    uint64_t cellCount;
+    vector<string> names;//Variable names, most significant cell bit first
+    vector<uint64_t> targets;//Cells holding the value being grouped, packed 64 per word
+    vector<uint64_t> dontCares;//Don't care cells, packed 64 per word
+    vector<int> groupsIn;//Number of groups each cell is in while solving
+    vector<Group> groups;//Groups formed in kmap
+    string solution = "";
+    int method;
+    CoverBudget budget;//Limits on the search for a minimum cover of prime implicants
+    int threadCount = 1;//Threads finding prime implicants and reducing their cover
+    bool fromCubes = false;//Whether the kmap was given cubes whose cells are not filled in yet
+    Cover onCubes;//Cells whose output is 1 when given as cubes
+    Cover dcCubes;//Don't care cells when given as cubes
+    ResultCache *cache = nullptr;//Groups found by earlier runs, looked up before solving
+    bool timedOut = false;//Whether the last search for a minimum cover stopped at budget.maxSeconds
+    SolveStats *stats = nullptr;//Times and counts of the phases of solving, if wanted
+
+    static bool testBit(const vector<uint64_t> &bits, uint64_t index) {
+        return (bits[index / 64] >> (index % 64)) & 1;
+    }
+    public:
+
+    //Returns the value of a cell (0, 1 or 2 for don't care)
+    int valueAt(uint64_t cell) {
+        if (testBit(dontCares, cell)) {
+            return 2;
+        }
+        return testBit(targets, cell) ? method : !method;
+    }
+
+    //For debugging purposes
+    void print() {
+        for (uint64_t x = 0; x < cellCount; x++) {
+            cout << x << " = " << valueAt(x) << " -> " << flush;
+            for (int y = 0; y < varCount; y++) {
+                cout << (x ^ (1ull << y)) << " = " << valueAt(x ^ (1ull << y)) << " -> " << flush;
+            }
+            cout << endl;
+        }
+    }
+        KarnaughMap(TruthTable* truthTable, int method) {
+            this->method = method;//Indicates whether to group 1's (SOP) or 0's (POS)
+            varCount = truthTable->inputCount();
+            cellCount = 1ull << varCount;
+            for (int x = 0; x < varCount; x++) {
+                names.push_back(truthTable->inputName(x));
+            }
+            targets = truthTable->packedOutput(method);
+            dontCares = truthTable->packedOutput(2);
+        }
+        //Constructor from cubes, such as lists of minterms, so sparse functions never need a truth table
+        //Espresso minimizes an SOP straight from the cubes, the other solvers fill in the kmap's cells first
+        KarnaughMap(vector<string> names, const Cover &onCubes, const Cover &dcCubes, int method) {
+            this->method = method;
+            this->names = names;
+            varCount = names.size();
+            cellCount = 1ull << varCount;
+            this->onCubes = onCubes;
+            this->dcCubes = dcCubes;
+            fromCubes = true;
+        }
+
+        //Fills targets and dontCares from the cubes the kmap was given, don't cares winning over 1's
+        void fillCells() {
+            if (!fromCubes) {
+                return;
+            }
+            STATS_PHASE(stats, "fill_cells");
+            if (varCount > 32) {
+                throw invalid_argument("Kmaps of more than 32 variables can only be solved by espresso in SOP form");
+            }
+            dontCares = coverTable(dcCubes, varCount);
+            targets = coverTable(onCubes, varCount);
+            for (uint64_t x = 0; x < targets.size(); x++) {
+                targets[x] = (method == 1 ? targets[x] : ~targets[x]) & ~dontCares[x];
+            }
+            if (cellCount < 64) {
+                targets[0] &= (1ull << cellCount) - 1;
+            }
+            fromCubes = false;
+            onCubes = Cover();
+            dcCubes = Cover();
+        }
+
+        //For debugging purposes
+        void printGroups(const vector<Group> &groupsToPrint) {
+            for (int x = 0; x < groupsToPrint.size(); x++) {
+                groupsToPrint.at(x).Print();
             }
-            return false;
         }
 
+        //Checks whether every cell of a group moved across the bits in shift may be grouped
+        bool checkExistence(const Group &group, uint64_t shift) {
+            bool exists = true;
+            group.forEach([&](uint64_t cell) {
+                exists = exists && (testBit(targets, cell ^ shift) || testBit(dontCares, cell ^ shift));
+            });
+            return exists;
+        }
+
+        void addGroup(vector<Group> &workingSet, const Group &group) {
+            group.forEach([this](uint64_t cell) {groupsIn[cell]++;});
+            workingSet.push_back(group);
+        }
 
         void makeGroups() {
             //Loop through every cell in the kmap
             //If the cell has not been grouped, make a new group of that singular cell
             //After the formation of the initial singular-cell group, try to extend that new group across a dimension to form a new group
             //repeat for each dimension
-            vector<Group*> workingSet;
-            Cell *curr = first;
-            int workingSetSize = 0;
-            int dimCount = cells.at(0)->adjacencies.size() / 2;
-            Group *newGroup;
-            bool twoLong;
-            while (curr != nullptr) {
-                if (curr->groupsIn == 0 && curr->value == method) {
-                    workingSet.push_back((new Group(curr)));
-                    curr->groupsIn++; workingSetSize++;
-                    //Extend all groups in working set through every dimension
-                    for (int x = 0; x < dimCount; x++) {
-                        for (int y = 0; y < workingSetSize; y++) {
-                            twoLong = (workingSet.at(y)->elements.at(0)->name == workingSet.at(y)->elements.at(0)->adjacencies.at(2*x)->adjacencies.at(2*x)->name);
-                            if (checkExistence(workingSet.at(y), 2*x + 1, method) && !twoLong) {
-                                newGroup = new Group();
-                                for (int z = 0; z < workingSet.at(y)->elements.size(); z++) {
-                                    newGroup->Add(workingSet.at(y)->elements.at(z));
-                                    workingSet.at(y)->elements.at(z)->groupsIn++;
-                                    newGroup->Add(workingSet.at(y)->elements.at(z)->adjacencies.at(2*x + 1));
-                                    workingSet.at(y)->elements.at(z)->adjacencies.at(2*x + 1)->groupsIn++;
-                                }
-                                workingSet.push_back(newGroup);
-                            }
-                            if (checkExistence(workingSet.at(y), 2*x, method)) {
-                                newGroup = new Group();
-                                for (int z = 0; z < workingSet.at(y)->elements.size(); z++) {
-                                    newGroup->Add(workingSet.at(y)->elements.at(z));
-                                    workingSet.at(y)->elements.at(z)->groupsIn++;
-                                    newGroup->Add(workingSet.at(y)->elements.at(z)->adjacencies.at(2*x));
-                                    workingSet.at(y)->elements.at(z)->adjacencies.at(2*x)->groupsIn++;
-                                }
-                                workingSet.push_back(newGroup);
-                            }
-                            if (checkExistence(workingSet.at(y), 2*x, method, "row") && !twoLong) {
-                                newGroup = new Group();
-                                for (int z = 0; z < workingSet.at(y)->elements.size(); z++) {
-                                    //Need to fix 
-                                    newGroup->Add(workingSet.at(y)->elements.at(z));
-                                    workingSet.at(y)->elements.at(z)->groupsIn++;
-                                    newGroup->Add(workingSet.at(y)->elements.at(z)->adjacencies.at(2*x));
-                                    workingSet.at(y)->elements.at(z)->adjacencies.at(2*x)->groupsIn++;
-                                    newGroup->Add(workingSet.at(y)->elements.at(z)->adjacencies.at(2*x)->adjacencies.at(2*x));
-                                    workingSet.at(y)->elements.at(z)->adjacencies.at(2*x)->adjacencies.at(2*x)->groupsIn++;
-                                    newGroup->Add(workingSet.at(y)->elements.at(z)->adjacencies.at(2*x)->adjacencies.at(2*x)->adjacencies.at(2*x));
-                                    workingSet.at(y)->elements.at(z)->adjacencies.at(2*x)->adjacencies.at(2*x)->adjacencies.at(2*x)->groupsIn++;
-                                    //Need to fix
-                                }
-                                workingSet.push_back(newGroup);
-                            }
+            //Dimension x spans cell bits 2x and 2x + 1, laid out in the gray code order 00, 01, 11, 10
+            //When varCount is odd the last dimension has a single bit and is only two cells long
+            vector<Group> workingSet;
+            int dimCount = (varCount + 1) / 2;
+            for (uint64_t cell = 0; cell < cellCount; cell++) {
+                if (groupsIn[cell] != 0 || !testBit(targets, cell)) {
+                    continue;
+                }
+                addGroup(workingSet, Group(cell, 0));
+                //Extend all groups in working set through every dimension
+                for (int x = 0; x < dimCount; x++) {
+                    uint64_t low = 1ull << (2*x);
+                    uint64_t high = 2*x + 1 < varCount ? 1ull << (2*x + 1) : 0;
+                    bool twoLong = high == 0;
+                    int workingSetSize = workingSet.size();
+                    for (int y = 0; y < workingSetSize; y++) {
+                        Group group = workingSet.at(y);
+                        //Stepping forward through the gray code flips the low bit from 00 and 11 and the high bit from 01 and 10
+                        bool bitsMatch = ((group.value & low) != 0) == ((group.value & high) != 0);
+                        uint64_t forward = (twoLong || bitsMatch) ? low : high;
+                        uint64_t backward = forward ^ low ^ high;
+                        if (!twoLong && checkExistence(group, backward)) {
+                            addGroup(workingSet, group.extend(backward));
+                        }
+                        if (checkExistence(group, forward)) {
+                            addGroup(workingSet, group.extend(forward));
+                        }
+                        if (!twoLong && checkExistence(group, low) && checkExistence(group, high) && checkExistence(group, low | high)) {
+                            addGroup(workingSet, group.extend(low | high));
                         }
-                        workingSetSize = workingSet.size();
                     }
-                for (int x = 0; x < workingSet.size(); x++) {
-                    groups.push_back(workingSet.at(x));
                 }
-                workingSet.clear(); workingSetSize = 0;
-                }
-                curr = curr->next;
-                
+                groups.insert(groups.end(), workingSet.begin(), workingSet.end());
+                workingSet.clear();
             }
             // printGroups(groups);
         }
 
         void removeUnnecessaryGroups() {
-            vector<Group*> allGroups;
-            int size = groups.size();
-            for (int x = 0; x < size; x++) {
-                allGroups.push_back(groups.at(x));
-            }
-            groups.clear();
+            vector<Group> allGroups;
+            allGroups.swap(groups);
             bool end = false;
-            bool alreadyAdded = false;
-            for (int x = 1; x > 0; x *= 2) {
+            for (uint64_t x = 1; x > 0; x *= 2) {
                 if (end) {break;}
                 end = true;
-                for (int y = 0; y < size; y++) {
-                    if (allGroups.at(y)->elements.size() == x) {
-                        alreadyAdded = false;
-                        for (int z = 0; z < x; z++) {
-                            if (allGroups.at(y)->elements.at(z)->groupsIn == 1 && !alreadyAdded) {
-                                groups.push_back(allGroups.at(y));
-                                alreadyAdded = true;
-                            }
+                for (const Group &group : allGroups) {
+                    if (group.size() == x) {
+                        bool necessary = false;
+                        group.forEach([&](uint64_t cell) {necessary = necessary || groupsIn[cell] == 1;});
+                        if (necessary) {
+                            groups.push_back(group);
                         }
-                        if (!alreadyAdded) {
-                            for (int z = 0; z < x; z++) {
-                                allGroups.at(y)->elements.at(z)->groupsIn--;
-                            }
+                        else {
+                            group.forEach([this](uint64_t cell) {groupsIn[cell]--;});
                         }
                         end = false;
                     }
@@ -413,8 +3594,6 @@ class KarnaughMap {
         }
         void getSolution() {
             int groupNum = groups.size();
-            int varNum = cells.at(0)->boolVars.size();
-            int groupSize;
             bool firstTerm;
             //If there are no groups, output is either always 0 or 1
             if (groups.size() == 0) {
@@ -427,7 +3606,7 @@ class KarnaughMap {
                 return;
             }
             //If there is one group containing all the cells, the output is either always 0 or 1
-            else if (groups.size() == 1 && groups.at(0)->elements.size() == cells.size()) {
+            else if (groups.size() == 1 && groups.at(0).size() == cellCount) {
                 if (method == 1) {
                     solution = "1";
                 }
@@ -441,46 +3620,864 @@ class KarnaughMap {
                 if (method == 0) {
                     solution += "(";
                 }
-                for (int y = 0; y < varNum; y++) {
-                    groupSize = groups.at(x)->elements.size();
-                    for (int z = 0; z < groupSize; z++) {
-                        if (groups.at(x)->elements.at(0)->boolVars.at(y)->sign != groups.at(x)->elements.at(z)->boolVars.at(y)->sign) {
-                            break;
-                        }
-                        if (z == groupSize - 1) {
-                            if (!firstTerm && method == 0) {
-                                solution += " + ";
-                            }
-                            if ((!groups.at(x)->elements.at(z)->boolVars.at(y)->sign && method == 1) || (groups.at(x)->elements.at(z)->boolVars.at(y)->sign && method == 0)) {
-                                solution += "~";
-                            }
-                            
-                            firstTerm = false;
-                            solution += groups.at(x)->elements.at(z)->boolVars.at(y)->name;
-                        }
+                for (int y = 0; y < varCount; y++) {
+                    uint64_t bit = 1ull << (varCount - 1 - y);
+                    //Variables whose bit differs within the group are eliminated
+                    if (groups.at(x).mask & bit) {
+                        continue;
+                    }
+                    bool sign = (groups.at(x).value & bit) != 0;
+                    if (!firstTerm && method == 0) {
+                        solution += " + ";
                     }
-                    
+                    if ((!sign && method == 1) || (sign && method == 0)) {
+                        solution += "~";
+                    }
+                    firstTerm = false;
+                    solution += names.at(y);
                 }
                 if (x != groupNum - 1 && method == 1) {
                     solution += " + ";
                 }
                 if (method == 0) {
                     solution += ")";
-                }                            
+                }
             }
         }
-        void solve() {
-            makeGroups();//Make all possible groups
-            removeUnnecessaryGroups();//Removes unnecessary groups
+        void setBudget(CoverBudget budget) {
+            this->budget = budget;
+        }
+        void setThreads(int threadCount) {
+            this->threadCount = threadCount;
+        }
+        void setCache(ResultCache *cache) {
+            this->cache = cache;
+        }
+        void setStats(SolveStats *stats) {
+            this->stats = stats;
+        }
+        void solve(Solver solver = GROUPING) {
+            groups.clear();
+            solution = "";
+            timedOut = false;
+            if (cache == nullptr || (fromCubes && solver == ESPRESSO && method == 1)) {
+                findGroups(solver);
+            }
+            else {
+                //The groups depend only on the cells, the solver and, for QUINE_MCCLUSKEY, the budget, so the kmap's names and form are left out of the key
+                fillCells();
+                FunctionKey key(varCount, solver, solver == QUINE_MCCLUSKEY ? budget : CoverBudget());
+                vector<vector<Group>> found;
+                bool hit;
+                {
+                    STATS_PHASE(stats, "cache_lookup");
+                    key.addFunction(targets, dontCares);
+                    key.finish();
+                    hit = cache->find(key, found);
+                }
+                STATS_COUNT(stats, hit ? "cache_hits" : "cache_misses", 1);
+                if (hit) {
+                    groups = found.at(0);
+                }
+                else {
+                    findGroups(solver);
+                    //A search cut short by the clock could find more on a faster or less busy machine, so only repeatable results are kept
+                    if (!timedOut) {
+                        STATS_PHASE(stats, "cache_insert");
+                        cache->insert(key, {groups});
+                    }
+                }
+            }
+#if KMAP_STATS
+            if (stats != nullptr) {
+                uint64_t literals = 0;
+                for (const Group &group : groups) {
+                    literals += varCount - popcount64(group.mask);
+                }
+                stats->count("groups", groups.size());
+                stats->count("literals", literals);
+            }
+#endif
+            STATS_PHASE(stats, "solution");
             getSolution();//Uses essential groups to solve for solution
         }
+        //Finds the kmap's groups with the chosen solver
+        void findGroups(Solver solver) {
+            //Cubes given for the 1's are already a cover, so espresso needs no cells to solve an SOP
+            bool sparse = fromCubes && solver == ESPRESSO && method == 1;
+            if (!sparse) {
+                fillCells();
+            }
+#if KMAP_STATS
+            if (stats != nullptr && !sparse) {
+                uint64_t targetCells = 0;
+                uint64_t dontCareCells = 0;
+                for (uint64_t x = 0; x < targets.size(); x++) {
+                    targetCells += popcount64(targets[x]);
+                    dontCareCells += popcount64(dontCares[x]);
+                }
+                stats->count("cells", cellCount);
+                stats->count("target_cells", targetCells);
+                stats->count("dont_care_cells", dontCareCells);
+            }
+#endif
+            if (sparse) {
+                STATS_COUNT(stats, "on_cubes", onCubes.size());
+                STATS_COUNT(stats, "dont_care_cubes", dcCubes.size());
+                STATS_PHASE(stats, "espresso");
+                groups = espresso(onCubes, dcCubes, varCount);
+            }
+            else if (solver == ESPRESSO) {
+                //Espresso's cover is already irredundant, so it goes straight to the solution
+                STATS_PHASE(stats, "espresso");
+                Espresso minimizer(targets, dontCares, varCount);
+                groups = minimizer.minimize();
+            }
+            else if (solver == QUINE_MCCLUSKEY) {
+                //Find all prime implicants, then the fewest of them covering every cell
+                WorkPool pool(threadCount);
+                vector<Group> primes;
+                {
+                    STATS_PHASE(stats, "prime_implicants");
+                    primes = primeImplicants(targets, dontCares, varCount, &pool);
+                }
+                STATS_COUNT(stats, "prime_implicants", primes.size());
+                groups = minimumCover(primes, targets, cellCount, budget, &pool, stats, &timedOut);
+            }
+            else {
+                groupsIn.assign(cellCount, 0);
+                {
+                    STATS_PHASE(stats, "make_groups");
+                    makeGroups();//Make all possible groups
+                }
+                STATS_COUNT(stats, "groups_made", groups.size());
+                {
+                    STATS_PHASE(stats, "remove_groups");
+                    removeUnnecessaryGroups();//Removes unnecessary groups
+                }
+                groupsIn = vector<int>();
+            }
+        }
+        //Changes cells of a solved kmap and repairs its groups around them instead of solving it again
+        //Cells are given as changes to the ON-set and DC-set, whichever form the kmap is in
+        void update(const TableDelta &delta) {
+            fillCells();
+            vector<uint64_t> addOn = coverTable(delta.addOn, varCount);
+            vector<uint64_t> removeOn = coverTable(delta.removeOn, varCount);
+            vector<uint64_t> addDontCare = coverTable(delta.addDontCare, varCount);
+            vector<uint64_t> removeDontCare = coverTable(delta.removeDontCare, varCount);
+            uint64_t last = cellCount < 64 ? (1ull << cellCount) - 1 : ~0ull;//Cells of the last word inside the kmap
+            vector<uint64_t> nextTargets(targets.size());
+            vector<uint64_t> nextDontCares(targets.size());
+            vector<uint64_t> changed(targets.size());
+            for (uint64_t x = 0; x < targets.size(); x++) {
+                uint64_t inside = x == targets.size() - 1 ? last : ~0ull;
+                uint64_t on = method == 1 ? targets[x] : ~targets[x] & ~dontCares[x] & inside;
+                nextDontCares[x] = (dontCares[x] & ~removeDontCare[x]) | addDontCare[x];
+                on = ((on & ~removeOn[x]) | addOn[x]) & ~nextDontCares[x];
+                nextTargets[x] = method == 1 ? on : ~on & ~nextDontCares[x] & inside;
+                changed[x] = (targets[x] ^ nextTargets[x]) | (dontCares[x] ^ nextDontCares[x]);
+            }
+            targets.swap(nextTargets);
+            dontCares.swap(nextDontCares);
+            WorkPool pool(threadCount);
+            groups = repairCover(groups, targets, dontCares, changed, varCount, budget, &pool);
+            solution = "";
+            getSolution();
+        }
+        //Uses groups chosen elsewhere, such as a cover shared with other kmaps, as the solution
+        void solveWith(const vector<Group> &chosen) {
+            groups = chosen;
+            solution = "";
+            getSolution();
+        }
         void printSolution() {
             cout << solution << endl;
         }
+        string returnSolution() {
+            return solution;
+        }
+        vector<Group> returnGroups() {
+            return groups;
+        }
+        int returnVarCount() {
+            return varCount;
+        }
 };
 
 //A collection of cells to form the kmap
 
+//Minterm list input code below
+//Reads a term as a cube: a string of exactly varCount characters from 0, 1 and - is a cube, anything else a row number
+Group parseTerm(const string &term, int varCount) {
+    if (term.size() == varCount && term.find_first_not_of("01-") == string::npos) {
+        Group cube(0, 0);
+        for (int y = 0; y < varCount; y++) {
+            uint64_t bit = 1ull << (varCount - 1 - y);
+            if (term[y] == '-') {
+                cube.mask |= bit;
+            }
+            else if (term[y] == '1') {
+                cube.value |= bit;
+            }
+        }
+        return cube;
+    }
+    if (term.empty() || term.size() > 19 || term.find_first_not_of("0123456789") != string::npos) {
+        throw invalid_argument("Term " + term + " is neither a row number nor a cube of " + to_string(varCount) + " variables");
+    }
+    uint64_t row = stoull(term);
+    if (row >> varCount != 0) {
+        throw invalid_argument("Row " + term + " is outside a kmap of " + to_string(varCount) + " variables");
+    }
+    return Group(row, 0);
+}
+
+//Sorts terms into the cubes whose output is 1 and, after a lone "d", the don't care cubes
+void parseTerms(const vector<string> &terms, int varCount, vector<Group> &onCubes, vector<Group> &dcCubes) {
+    vector<Group> *cubes = &onCubes;
+    for (const string &term : terms) {
+        if (term == "d") {
+            cubes = &dcCubes;
+        }
+        else {
+            cubes->push_back(parseTerm(term, varCount));
+        }
+    }
+}
+
+//Disjoint cubes covering the cells of a outside b, found by splitting a on each variable b fixes and a leaves free
+Cover cubeDifference(const Group &a, const Group &b) {
+    if (!intersects(a, b)) {
+        return {a};
+    }
+    Cover result;
+    Group rest = a;
+    uint64_t split = a.mask & ~b.mask;
+    while (split != 0) {
+        uint64_t bit = split & -split;
+        split &= split - 1;
+        rest.mask &= ~bit;
+        result.push_back(Group(rest.value | (~b.value & bit), rest.mask));
+        rest.value |= b.value & bit;
+    }
+    return result;
+}
+
+//Reads the changes to a function's cells from words such as "on 5 7 off 1-0 dc 3", where cells after "on" become 1,
+//cells after "off" become 0 and cells after "dc" become don't cares
+//Words apply from left to right, so a cell named more than once takes the last change, as in "on 1-- off 101"
+TableDelta parseDelta(const vector<string> &words, int varCount) {
+    vector<pair<string, Group>> changes;
+    string kind = "";
+    for (const string &word : words) {
+        if (word == "on" || word == "off" || word == "dc") {
+            kind = word;
+            continue;
+        }
+        if (kind == "") {
+            throw invalid_argument("Changed cells must follow on, off or dc");
+        }
+        changes.push_back(make_pair(kind, parseTerm(word, varCount)));
+    }
+    //Each change keeps only the cells no later change names
+    TableDelta delta;
+    Cover later;
+    for (int x = changes.size() - 1; x >= 0; x--) {
+        Cover pieces = {changes[x].second};
+        for (const Group &cube : later) {
+            Cover outside;
+            for (const Group &piece : pieces) {
+                Cover difference = cubeDifference(piece, cube);
+                outside.insert(outside.end(), difference.begin(), difference.end());
+            }
+            pieces.swap(outside);
+        }
+        later.push_back(changes[x].second);
+        for (const Group &piece : pieces) {
+            if (changes[x].first == "dc") {
+                delta.addDontCare.push_back(piece);
+            }
+            else {
+                (changes[x].first == "on" ? delta.addOn : delta.removeOn).push_back(piece);
+                delta.removeDontCare.push_back(piece);
+            }
+        }
+    }
+    return delta;
+}
+
+void readTerms(istream &in, vector<string> &terms) {
+    string term;
+    while (in >> term) {
+        terms.push_back(term);
+    }
+}
+//Minterm list input code above
+
+//Function input code below
+//Builds the kmap of a function from the words describing it, as on the command line: (sop or pos) (tt, ex or mt) (data)
+//Terms of a minterm list kept elsewhere, such as in a file, are passed in as extraTerms and read after the words
+unique_ptr<KarnaughMap> readFunction(const vector<string> &words, const vector<string> &extraTerms = vector<string>()) {
+    if (words.size() < 2 || words[0].size() < 3 || words[1].size() < 2) {
+        throw invalid_argument("A function needs a form (sop or pos) and a format (tt, ex or mt)");
+    }
+    //Establish desired method (1 means SOP, 0 means POS)
+    int method;
+    const string &form = words[0];
+    if ((form[0] == 's' || form[0] == 'S') && (form[1] == 'o' || form[1] == 'O') && (form[2] == 'p' || form[2] == 'P')) {
+        method = 1;
+    }
+    else if ((form[0] == 'p' || form[0] == 'P') && (form[1] == 'o' || form[1] == 'O') && (form[2] == 's' || form[2] == 'S')) {
+        method = 0;
+    }
+    else {
+        throw invalid_argument("Unknown form " + form + ", expected sop or pos");
+    }
+
+    const string &format = words[1];
+    //Build truth table from entered variables and outputs
+    if ((format[0] == 't' || format[0] == 'T') && (format[1] == 't' || format[1] == 'T')) {
+        vector<string> inputNames;
+        vector<int> outputs;
+        bool passed = false;
+        for (int x = 2; x < words.size(); x++) {
+            if (passed) {
+                if (words[x][0] == '1') {
+                    outputs.push_back(1);
+                }
+                else if (words[x][0] == 'd') {
+                    outputs.push_back(2);
+                }
+                else {
+                    outputs.push_back(0);
+                }
+            }
+            else if (words[x][0] != 'f') {
+                inputNames.push_back(words[x]);
+            }
+            else {
+                passed = true;
+            }
+        }
+        if (inputNames.size() >= 64 || outputs.size() != 1ull << inputNames.size()) {
+            string rowCount = inputNames.size() >= 64 ? "2^" + to_string(inputNames.size()) : to_string(1ull << inputNames.size());
+            throw invalid_argument("A truth table of " + to_string(inputNames.size()) + " variables needs " + rowCount + " outputs, not " + to_string(outputs.size()));
+        }
+        TruthTable truthTable(inputNames, "f", outputs);
+        return unique_ptr<KarnaughMap>(new KarnaughMap(&truthTable, method));
+    }
+    //Build truth table from boolean expression
+    if ((format[0] == 'e' || format[0] == 'E') && (format[1] == 'x' || format[1] == 'X')) {
+        string expression = "";
+        for (int x = 2; x < words.size(); x++) {
+            expression += words[x];
+        }
+        TruthTable truthTable(expression);
+        return unique_ptr<KarnaughMap>(new KarnaughMap(&truthTable, method));
+    }
+    //Form kmap straight from lists of minterms, without building a truth table
+    if ((format[0] == 'm' || format[0] == 'M') && (format[1] == 't' || format[1] == 'T')) {
+        vector<string> inputNames;
+        vector<string> terms;
+        bool passed = false;
+        for (int x = 2; x < words.size(); x++) {
+            if (passed) {
+                terms.push_back(words[x]);
+            }
+            else if (words[x] != "f") {
+                inputNames.push_back(words[x]);
+            }
+            else {
+                passed = true;
+            }
+        }
+        if (inputNames.size() > 63) {
+            throw invalid_argument("Minterm lists are limited to 63 variables");
+        }
+        terms.insert(terms.end(), extraTerms.begin(), extraTerms.end());
+        vector<Group> onCubes;
+        vector<Group> dcCubes;
+        parseTerms(terms, inputNames.size(), onCubes, dcCubes);
+        return unique_ptr<KarnaughMap>(new KarnaughMap(inputNames, onCubes, dcCubes, method));
+    }
+    throw invalid_argument("Unknown format " + format + ", expected tt, ex or mt");
+}
+//Function input code above
+
+//Batch code below
+//A batch is a stream of functions, one per line: a name and then the words that would solve it alone, as in "f1 sop tt a b c f 1 1 0 1 0 d d 1"
+//Each function prints as its name, a colon and its solution, in the order the functions were read, with an error in place of the solution if it could not be read
+//Blank lines and lines starting with # are skipped
+//The reading thread queues lines for the worker threads, but only reads a line while fewer than window lines are waiting to be printed,
+//so a batch of any size is solved in bounded memory, and a slow function holds back only the printing of those after it
+struct BatchOptions {
+    Solver solver = GROUPING;
+    CoverBudget budget;
+    int threadCount = 1;//Functions solved at once
+    ResultCache *cache = nullptr;
+    SolveStats *stats = nullptr;//Phases and counts summed over every function, if wanted
+};
+
+class BatchRunner {
+    BatchOptions options;
+    ostream &out;
+    uint64_t window;
+    mutex lock;
+    condition_variable jobReady;//Tells workers a line was queued or the input ended
+    condition_variable roomReady;//Tells the reader results were printed
+    queue<pair<uint64_t, string>> jobs;//Lines read but not taken by a worker, with their position in the batch
+    vector<string> results;//Results waiting on those before them, result x kept at x % window
+    vector<char> finished;//Whether each entry of results is filled
+    uint64_t printed = 0;
+    bool ended = false;
+
+    string solveLine(const string &line) {
+        istringstream stream(line);
+        vector<string> words;
+        string word;
+        while (stream >> word) {
+            words.push_back(word);
+        }
+        string name = words.at(0);
+        words.erase(words.begin());
+        SolveStats stats;
+        SolveStats *lineStats = options.stats != nullptr ? &stats : nullptr;
+        string result;
+        try {
+            unique_ptr<KarnaughMap> kmap;
+            {
+                STATS_PHASE(lineStats, "read");
+                kmap = readFunction(words);
+            }
+            kmap->setBudget(options.budget);
+            kmap->setCache(options.cache);
+            kmap->setStats(lineStats);
+            kmap->solve(options.solver);
+            result = name + ": " + kmap->returnSolution();
+        }
+        catch (const exception &error) {
+            result = name + ": error: " + error.what();
+            STATS_COUNT(lineStats, "errors", 1);
+        }
+        if (lineStats != nullptr) {
+            stats.count("functions", 1);
+            lock_guard<mutex> guard(lock);
+            options.stats->merge(stats);
+        }
+        return result;
+    }
+    void work() {
+        while (true) {
+            pair<uint64_t, string> job;
+            {
+                unique_lock<mutex> guard(lock);
+                jobReady.wait(guard, [&]() {return !jobs.empty() || ended;});
+                if (jobs.empty()) {
+                    return;
+                }
+                job = move(jobs.front());
+                jobs.pop();
+            }
+            string result = solveLine(job.second);
+            lock_guard<mutex> guard(lock);
+            results[job.first % window] = move(result);
+            finished[job.first % window] = 1;
+            //Whoever finishes the next result in order prints it and any finished after it
+            uint64_t before = printed;
+            while (finished[printed % window]) {
+                out << results[printed % window] << '\n';
+                results[printed % window] = string();
+                finished[printed % window] = 0;
+                printed++;
+            }
+            if (printed != before) {
+                //Flushing only once the workers have caught up with the input keeps output prompt without a write per function
+                if (jobs.empty()) {
+                    out.flush();
+                }
+                roomReady.notify_one();
+            }
+        }
+    }
+
+    public:
+    BatchRunner(ostream &out, BatchOptions options) : out(out) {
+        this->options = options;
+        this->options.threadCount = max(options.threadCount, 1);
+        window = max(256, 16 * this->options.threadCount);
+        results.resize(window);
+        finished.assign(window, 0);
+    }
+    void run(istream &in) {
+        vector<thread> workers;
+        for (int x = 0; x < options.threadCount; x++) {
+            workers.push_back(thread(&BatchRunner::work, this));
+        }
+        string line;
+        uint64_t read = 0;
+        while (getline(in, line)) {
+            size_t start = line.find_first_not_of(" \t\r");
+            if (start == string::npos || line[start] == '#') {
+                continue;
+            }
+            unique_lock<mutex> guard(lock);
+            roomReady.wait(guard, [&]() {return read - printed < window;});
+            jobs.push(make_pair(read++, line));
+            jobReady.notify_one();
+        }
+        {
+            lock_guard<mutex> guard(lock);
+            ended = true;
+        }
+        jobReady.notify_all();
+        for (thread &worker : workers) {
+            worker.join();
+        }
+        out.flush();
+    }
+};
+
+//Solves every function of a batch read from in, printing the results to out
+void runBatch(istream &in, ostream &out, BatchOptions options) {
+    BatchRunner(out, options).run(in);
+}
+//Batch code above
+
+//Benchmark code below
+//"bench" times the solvers on seeded random functions and on families of structured ones, printing one JSON object per case and solver
+//A random function makes each row don't care with probability --dc, 1 with probability --on and 0 otherwise
+//The structured families are parity, majority (more than half the inputs set), adder (the carry out of adding the two halves of the inputs)
+//and mux (the first k inputs pick one of the other 2^k, so only 3, 6, 11 and 20 variables have one)
+//Each case reports its solve time, the time per minterm of its ON-set, its peak RSS and the products and literals of its solution
+//Where fork is available each case runs in its own process, so its peak RSS is its own and a case running past --bench-timeout is stopped
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#define HAS_BENCH_PROCESSES
+#endif
+
+struct BenchOptions {
+    vector<string> families;
+    vector<Solver> solvers;
+    int minVars = 2;
+    int maxVars = 12;
+    uint64_t seed = 1;
+    double on = 0.5;
+    double dc = 0.1;
+    int repeat = 3;//Each case is solved this many times and the fastest kept
+    int timeout = 60;//Seconds
+    CoverBudget budget;
+    int threadCount = 1;
+};
+
+string solverName(Solver solver) {
+    return solver == QUINE_MCCLUSKEY ? "qm" : solver == ESPRESSO ? "espresso" : "kmap";
+}
+
+//Fills the planes of a family's function of varCount variables, returning false if the family has none of that size
+bool benchFunction(const string &family, int varCount, const BenchOptions &options, vector<uint64_t> &on, vector<uint64_t> &dontCare) {
+    uint64_t rowCount = 1ull << varCount;
+    on.assign((rowCount + 63) / 64, 0);
+    dontCare.assign(on.size(), 0);
+    int half = varCount / 2;
+    int select = 0;
+    while (select + (1 << select) < varCount) {
+        select++;
+    }
+    if ((family == "adder" && varCount % 2 != 0) || (family == "mux" && select + (1 << select) != varCount)) {
+        return false;
+    }
+    if (family != "random" && family != "parity" && family != "majority" && family != "adder" && family != "mux") {
+        throw invalid_argument("Unknown benchmark family " + family + ", expected random, parity, majority, adder or mux");
+    }
+    mt19937_64 random(options.seed * 0x9E3779B97F4A7C15ull + varCount);
+    uint64_t onLimit = (uint64_t) (options.on * 4294967296.0);
+    uint64_t dcLimit = (uint64_t) (options.dc * 4294967296.0);
+    for (uint64_t row = 0; row < rowCount; row++) {
+        int value;
+        if (family == "random") {
+            uint64_t draw = random();
+            draw >>= 32;
+            value = draw < dcLimit ? 2 : draw < dcLimit + onLimit;
+        }
+        else if (family == "parity") {
+            value = popcount64(row) & 1;
+        }
+        else if (family == "majority") {
+            value = popcount64(row) * 2 > varCount;
+        }
+        else if (family == "adder") {
+            uint64_t low = (1ull << half) - 1;
+            value = (((row >> half) + (row & low)) >> half) & 1;
+        }
+        else {
+            int dataCount = 1 << select;
+            uint64_t picked = row >> dataCount;
+            value = (row >> (dataCount - 1 - picked)) & 1;
+        }
+        if (value == 2) {
+            dontCare[row / 64] |= 1ull << (row % 64);
+        }
+        else if (value == 1) {
+            on[row / 64] |= 1ull << (row % 64);
+        }
+    }
+    return true;
+}
+
+//Solves one case, returning its measurements as JSON fields
+string benchCase(const string &family, int varCount, Solver solver, const BenchOptions &options) {
+    vector<uint64_t> on;
+    vector<uint64_t> dontCare;
+    benchFunction(family, varCount, options, on, dontCare);
+    vector<string> names;
+    for (int x = 0; x < varCount; x++) {
+        names.push_back("x" + to_string(x));
+    }
+    TruthTable truthTable(names, "f", on, dontCare);
+    double best = 0;
+    vector<Group> groups;
+    for (int x = 0; x < max(options.repeat, 1); x++) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        KarnaughMap kmap(&truthTable, 1);
+        kmap.setBudget(options.budget);
+        kmap.setThreads(options.threadCount);
+        kmap.solve(solver);
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        if (x == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+        groups = kmap.returnGroups();
+    }
+    uint64_t minterms = countOnes(on);
+    uint64_t dontCares = countOnes(dontCare);
+    uint64_t literals = 0;
+    for (const Group &group : groups) {
+        literals += varCount - popcount64(group.mask);
+    }
+    ostringstream out;
+    out << "\"minterms\": " << minterms << ", \"dont_cares\": " << dontCares << ", \"seconds\": " << best
+        << ", \"ns_per_minterm\": " << best * 1e9 / max(minterms, (uint64_t) 1) << ", \"products\": " << groups.size() << ", \"literals\": " << literals;
+    return out.str();
+}
+
+//Runs every case of options, printing a line of JSON for each as it finishes
+void runBench(const BenchOptions &options, ostream &out) {
+    for (const string &family : options.families) {
+        for (int varCount = options.minVars; varCount <= options.maxVars; varCount++) {
+            vector<uint64_t> on;
+            vector<uint64_t> dontCare;
+            if (!benchFunction(family, varCount, options, on, dontCare)) {
+                continue;
+            }
+            for (Solver solver : options.solvers) {
+                out << "{\"family\": \"" << family << "\", \"vars\": " << varCount << ", \"solver\": \"" << solverName(solver) << "\"";
+                if (family == "random") {
+                    out << ", \"seed\": " << options.seed << ", \"on\": " << options.on << ", \"dc\": " << options.dc;
+                }
+                string status = "ok";
+                string fields;
+                long peakKilobytes = 0;
+#ifdef HAS_BENCH_PROCESSES
+                //The case runs in a child process, which writes its fields back through a pipe
+                int channel[2];
+                if (pipe(channel) != 0) {
+                    throw runtime_error("Could not create a pipe for a benchmark case");
+                }
+                out.flush();
+                pid_t child = fork();
+                if (child == 0) {
+                    close(channel[0]);
+                    alarm(options.timeout);
+                    string result = benchCase(family, varCount, solver, options);
+                    ssize_t written = write(channel[1], result.data(), result.size());
+                    _exit(written == (ssize_t) result.size() ? 0 : 1);
+                }
+                close(channel[1]);
+                char buffer[4096];
+                ssize_t count;
+                while ((count = read(channel[0], buffer, sizeof(buffer))) > 0) {
+                    fields.append(buffer, count);
+                }
+                close(channel[0]);
+                int exitStatus = 0;
+                struct rusage usage;
+                wait4(child, &exitStatus, 0, &usage);
+                peakKilobytes = usage.ru_maxrss;
+#ifdef __APPLE__
+                peakKilobytes /= 1024;//macOS reports bytes
+#endif
+                if (WIFSIGNALED(exitStatus)) {
+                    status = WTERMSIG(exitStatus) == SIGALRM ? "timeout" : "crashed";
+                }
+                else if (WEXITSTATUS(exitStatus) != 0 || fields.empty()) {
+                    status = "failed";
+                }
+#else
+                fields = benchCase(family, varCount, solver, options);
+#endif
+                out << ", \"status\": \"" << status << "\"";
+                if (status == "ok") {
+                    out << ", " << fields << ", \"peak_rss_kb\": " << peakKilobytes;
+                }
+                out << "}" << endl;
+            }
+        }
+    }
+}
+//Benchmark code above
+
+//Allocation counting code below
+#if KMAP_STATS
+//Replaces the global operator new so --stats can count allocations, which costs one untaken branch per allocation otherwise
+//Every form is replaced, plain, array, nothrow and aligned, with matching deletes, so all memory comes from and goes back to malloc
+#include <cstdlib>
+#include <new>
+
+//Memory for one allocation, or nullptr once the new handler gives up (or throws bad_alloc if throwing is set)
+void *countedAllocate(size_t size, size_t alignment, bool throwing) {
+    if (countAllocations) {
+        allocationCount.fetch_add(1, memory_order_relaxed);
+    }
+    size = max(size, (size_t) 1);
+    while (true) {
+        //aligned_alloc needs a size that is a multiple of the alignment
+        void *memory = alignment == 0 ? malloc(size) : aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        if (memory != nullptr) {
+            return memory;
+        }
+        new_handler handler = get_new_handler();
+        if (handler == nullptr) {
+            if (throwing) {
+                throw bad_alloc();
+            }
+            return nullptr;
+        }
+        if (throwing) {
+            handler();
+        }
+        else {
+            try {
+                handler();
+            }
+            catch (const bad_alloc &) {
+                return nullptr;
+            }
+        }
+    }
+}
+
+void *operator new(size_t size) {
+    return countedAllocate(size, 0, true);
+}
+void *operator new[](size_t size) {
+    return countedAllocate(size, 0, true);
+}
+void *operator new(size_t size, const nothrow_t &) noexcept {
+    return countedAllocate(size, 0, false);
+}
+void *operator new[](size_t size, const nothrow_t &) noexcept {
+    return countedAllocate(size, 0, false);
+}
+void *operator new(size_t size, align_val_t alignment) {
+    return countedAllocate(size, (size_t) alignment, true);
+}
+void *operator new[](size_t size, align_val_t alignment) {
+    return countedAllocate(size, (size_t) alignment, true);
+}
+void *operator new(size_t size, align_val_t alignment, const nothrow_t &) noexcept {
+    return countedAllocate(size, (size_t) alignment, false);
+}
+void *operator new[](size_t size, align_val_t alignment, const nothrow_t &) noexcept {
+    return countedAllocate(size, (size_t) alignment, false);
+}
+//Sizes and alignments passed to delete are not needed by free
+void operator delete(void *memory) noexcept {
+    free(memory);
+}
+void operator delete[](void *memory) noexcept {
+    free(memory);
+}
+void operator delete(void *memory, size_t) noexcept {
+    free(memory);
+}
+void operator delete[](void *memory, size_t) noexcept {
+    free(memory);
+}
+void operator delete(void *memory, const nothrow_t &) noexcept {
+    free(memory);
+}
+void operator delete[](void *memory, const nothrow_t &) noexcept {
+    free(memory);
+}
+void operator delete(void *memory, align_val_t) noexcept {
+    free(memory);
+}
+void operator delete[](void *memory, align_val_t) noexcept {
+    free(memory);
+}
+void operator delete(void *memory, size_t, align_val_t) noexcept {
+    free(memory);
+}
+void operator delete[](void *memory, size_t, align_val_t) noexcept {
+    free(memory);
+}
+void operator delete(void *memory, align_val_t, const nothrow_t &) noexcept {
+    free(memory);
+}
+void operator delete[](void *memory, align_val_t, const nothrow_t &) noexcept {
+    free(memory);
+}
+#endif
+//Allocation counting code above
+
+//Option value code below
+const int MAX_THREADS = 1024;
+const double MAX_SECONDS = 1e9;
+const double MAX_CACHE_MEGABYTES = 1e12;//Far below the 2^44 megabytes that would overflow a count of bytes
+//An option's value must be a number as a whole and inside the option's range, otherwise the error names the option
+uint64_t wholeOption(const string &option, const string &value, uint64_t low, uint64_t high) {
+    string expected = option + " needs a whole number from " + to_string(low) + (high == UINT64_MAX ? " up" : " to " + to_string(high)) + ", not " + value;
+    if (value.empty() || !isdigit((unsigned char) value[0])) {
+        throw invalid_argument(expected);
+    }
+    size_t length = 0;
+    uint64_t number;
+    try {
+        number = stoull(value, &length);
+    }
+    catch (const exception &) {
+        throw invalid_argument(expected);
+    }
+    if (length != value.size() || number < low || number > high) {
+        throw invalid_argument(expected);
+    }
+    return number;
+}
+uint64_t wholeOption(const string &option, const string &value, uint64_t low = 0) {
+    return wholeOption(option, value, low, UINT64_MAX);
+}
+double numberOption(const string &option, const string &value, double low, double high) {
+    ostringstream expected;
+    expected << option << " needs a number from " << low << " to " << high << ", not " << value;
+    size_t length = 0;
+    double number;
+    try {
+        number = stod(value, &length);
+    }
+    catch (const exception &) {
+        throw invalid_argument(expected.str());
+    }
+    if (length != value.size() || !(number >= low && number <= high)) {
+        throw invalid_argument(expected.str());
+    }
+    return number;
+}
+//Option value code above
+
 //Program components listed above
 
 int main(int argc, char* argv[]) {
@@ -506,71 +4503,251 @@ int main(int argc, char* argv[]) {
     //Solve k-map to find solution
     //Print solutiuon
 
-    //First check if input is only one variable, in which case solve and return
-    if (argv[4][0] == 'f') { 
-        if (argv[5][0] == '0' || argv[5][0] == 'd') {
-            cout << '~';
+    //Options start with "--" and may appear anywhere, they are removed before the remaining arguments are read
+    Solver solver = GROUPING;
+    CoverBudget budget;
+    budget.maxNodes = 50000;
+    int threadCount = 1;
+    budget.maxSeconds = 2;
+    string inputPath = "";
+    string deltaPath = "";
+    string cachePath = "";
+    uint64_t cacheBytes = 64ull << 20;
+    bool printStats = false;
+    bool solverChosen = false;
+    BenchOptions bench;
+    vector<char*> arguments;
+    try {
+        for (int x = 0; x < argc; x++) {
+            string argument = argv[x];
+            if (argument == "--solver" && x + 1 < argc) {
+                solverChosen = true;
+                string name = argv[++x];
+                if (name == "qm") {
+                    solver = QUINE_MCCLUSKEY;
+                }
+                else if (name == "espresso") {
+                    solver = ESPRESSO;
+                }
+                else if (name != "kmap") {
+                    cout << "Unknown solver " << name << endl;
+                    return 1;
+                }
+            }
+            else if (argument == "--max-nodes" && x + 1 < argc) {
+                budget.maxNodes = wholeOption(argument, argv[++x]);
+            }
+            else if (argument == "--max-seconds" && x + 1 < argc) {
+                budget.maxSeconds = numberOption(argument, argv[++x], 0, MAX_SECONDS);
+            }
+            else if (argument == "--threads" && x + 1 < argc) {
+                threadCount = wholeOption(argument, argv[++x], 1, MAX_THREADS);
+            }
+            else if (argument == "--input" && x + 1 < argc) {
+                inputPath = argv[++x];
+            }
+            else if (argument == "--delta" && x + 1 < argc) {
+                deltaPath = argv[++x];
+            }
+            else if (argument == "--cache" && x + 1 < argc) {
+                cachePath = argv[++x];
+            }
+            else if (argument == "--cache-size" && x + 1 < argc) {
+                cacheBytes = (uint64_t) (numberOption(argument, argv[++x], 0, MAX_CACHE_MEGABYTES) * (1 << 20));
+            }
+            else if (argument == "--stats") {
+                printStats = true;
+            }
+            else if (argument == "--vars" && x + 1 < argc) {
+                string range = argv[++x];
+                size_t dash = range.find('-');
+                bench.minVars = wholeOption(argument, range.substr(0, dash), 1, 32);
+                bench.maxVars = dash == string::npos ? bench.minVars : wholeOption(argument, range.substr(dash + 1), 1, 32);
+                if (bench.minVars > bench.maxVars) {
+                    throw invalid_argument(argument + " needs its fewest variables first, not " + range);
+                }
+            }
+            else if (argument == "--seed" && x + 1 < argc) {
+                bench.seed = wholeOption(argument, argv[++x]);
+            }
+            else if (argument == "--on" && x + 1 < argc) {
+                bench.on = numberOption(argument, argv[++x], 0, 1);
+            }
+            else if (argument == "--dc" && x + 1 < argc) {
+                bench.dc = numberOption(argument, argv[++x], 0, 1);
+            }
+            else if (argument == "--repeat" && x + 1 < argc) {
+                bench.repeat = wholeOption(argument, argv[++x], 1, INT32_MAX);
+            }
+            else if (argument == "--bench-timeout" && x + 1 < argc) {
+                bench.timeout = wholeOption(argument, argv[++x], 1, INT32_MAX);
+            }
+            else {
+                arguments.push_back(argv[x]);
+            }
         }
-        cout << argv[3][0] << endl;
-        return 0;
     }
-
-    //Establish desired method (1 means SOP, 2 means POS)
-    int method;
-    if ((argv[1][0] == 's' || argv[1][0] == 'S') && (argv[1][1] == 'o' || argv[1][1] == 'O') && (argv[1][2] == 'p' || argv[1][2] == 'P')) {
-        method = 1;
+    catch (const invalid_argument &error) {
+        cout << error.what() << endl;
+        return 1;
     }
-    if ((argv[1][0] == 'p' || argv[1][0] == 'P') && (argv[1][1] == 'o' || argv[1][1] == 'O') && (argv[1][2] == 's' || argv[1][2] == 'S')) {
-        method = 0;
+    argc = arguments.size();
+    argv = arguments.data();
+#if KMAP_STATS
+    SolveStats stats;
+    SolveStats *wantedStats = printStats ? &stats : nullptr;
+    countAllocations = printStats;
+#else
+    if (printStats) {
+        cerr << "Statistics were left out of this build, it must be built without KMAP_STATS=0 for --stats" << endl;
     }
-    
-    //Build truth table out of either entered values or expression
-    TruthTable *truthTable;
+    SolveStats *wantedStats = nullptr;
+#endif
 
-    //Build truth table from entered variables and outputs if prompted
-    if (((argv[2][0] == 't' || argv[2][0] == 'T') && (argv[2][1] == 't' || argv[2][1] == 'T'))) {
-    vector<string> inputNames;
-    vector<int> outputs;
-    bool passed = false;
-    for (int x = 3; x < argc; x++) {
-        if (passed) {
-            if (*argv[x] == '1') {
-                outputs.push_back(1);
-            }
-            else if (*argv[x] == 'd') {
-                outputs.push_back(2);
-            }
-            else {
-                outputs.push_back(0);
-            }
+    //Benchmark the solvers if prompted
+    if (argc > 1 && string(argv[1]) == "bench") {
+        bench.families = vector<string>(argv + 2, argv + argc);
+        if (bench.families.empty()) {
+            bench.families = {"random", "parity", "majority", "adder", "mux"};
+        }
+        bench.solvers = solverChosen ? vector<Solver>{solver} : vector<Solver>{GROUPING, QUINE_MCCLUSKEY, ESPRESSO};
+        bench.budget = budget;
+        bench.threadCount = threadCount;
+        if (bench.on + bench.dc > 1) {
+            cout << "--on and --dc are probabilities of the same row, so together they may be at most 1" << endl;
+            return 1;
         }
-        else if (*argv[x] != 'f') {
+        try {
+            runBench(bench, cout);
+        }
+        catch (const exception &error) {
+            cout << error.what() << endl;
+            return 1;
+        }
+        return 0;
+    }
 
-            inputNames.push_back(argv[x]);
+    //Solve a batch of functions if prompted
+    if (argc > 1 && string(argv[1]) == "batch") {
+        BatchOptions options;
+        options.solver = solver;
+        options.budget = budget;
+        options.threadCount = threadCount;
+        options.stats = wantedStats;
+        unique_ptr<ResultCache> cache;
+        if (cachePath != "") {
+            cache.reset(new ResultCache(cachePath, cacheBytes));
+            options.cache = cache.get();
+        }
+        if (argc > 2) {
+            ifstream file(argv[2]);
+            if (!file) {
+                cout << "Could not open " << argv[2] << endl;
+                return 1;
+            }
+            runBatch(file, cout, options);
         }
         else {
-            passed = true;
+            runBatch(cin, cout, options);
         }
+        if (wantedStats != nullptr) {
+            cerr << wantedStats->json() << endl;
+        }
+        return 0;
     }
-        truthTable = new TruthTable(inputNames, "f", outputs);
+
+    //First check if input is a one variable truth table, in which case solve and return
+    if (argc > 5 && (argv[2][0] == 't' || argv[2][0] == 'T') && argv[4][0] == 'f') { 
+        if (argv[5][0] == '0' || argv[5][0] == 'd') {
+            cout << '~';
+        }
+        cout << argv[3][0] << endl;
+        return 0;
     }
-    
-    //Build truth table from boolean expression if entered
-    if (((argv[2][0] == 'e' || argv[2][0] == 'E') && (argv[2][1] == 'x' || argv[2][1] == 'X'))) {
+
+    vector<string> words(argv + 1, argv + argc);
+    vector<string> extraTerms;
+    //An entered expression is echoed before its solution
+    if (words.size() > 1 && words[1].size() > 1 && (words[1][0] == 'e' || words[1][0] == 'E') && (words[1][1] == 'x' || words[1][1] == 'X')) {
         string expression = "";
-        for (int x = 3; x < argc; x++) {
-            expression += argv[x];
+        for (int x = 2; x < words.size(); x++) {
+            expression += words[x];
         }
         cout << expression << endl;
-        truthTable = new TruthTable(expression);
+    }
+    //Terms of a minterm list come from a file if given, or standard input if none follow "f"
+    if (words.size() > 1 && words[1].size() > 1 && (words[1][0] == 'm' || words[1][0] == 'M') && (words[1][1] == 't' || words[1][1] == 'T')) {
+        if (inputPath != "") {
+            ifstream file(inputPath);
+            if (!file) {
+                cout << "Could not open " << inputPath << endl;
+                return 1;
+            }
+            readTerms(file, extraTerms);
+        }
+        else if (words.back() == "f") {
+            readTerms(cin, extraTerms);
+        }
     }
 
-    //Form kmap from truth table
-    KarnaughMap *kmap = new KarnaughMap(truthTable, method);
+    //Build kmap from either entered values, expression or minterms
+    unique_ptr<KarnaughMap> kmap;
+    try {
+        STATS_PHASE(wantedStats, "read");
+        kmap = readFunction(words, extraTerms);
+    }
+    catch (const invalid_argument &error) {
+        cout << error.what() << endl;
+        return 1;
+    }
 
     //Solve kmap
-    kmap->solve();
+    kmap->setBudget(budget);
+    kmap->setThreads(threadCount);
+    kmap->setStats(wantedStats);
+    unique_ptr<ResultCache> cache;
+    if (cachePath != "") {
+        cache.reset(new ResultCache(cachePath, cacheBytes));
+        kmap->setCache(cache.get());
+    }
+    try {
+        kmap->solve(solver);
+    }
+    catch (const invalid_argument &error) {
+        cout << error.what() << endl;
+        return 1;
+    }
 
     //Print solution
     kmap->printSolution();
+
+    //Repair the solution after each line of changes, if given
+    if (deltaPath != "") {
+        ifstream file(deltaPath);
+        if (!file) {
+            cout << "Could not open " << deltaPath << endl;
+            return 1;
+        }
+        string line;
+        while (getline(file, line)) {
+            istringstream lineIn(line);
+            vector<string> lineWords;
+            readTerms(lineIn, lineWords);
+            if (lineWords.empty()) {
+                continue;
+            }
+            try {
+                STATS_PHASE(wantedStats, "repair");
+                kmap->update(parseDelta(lineWords, kmap->returnVarCount()));
+            }
+            catch (const invalid_argument &error) {
+                cout << error.what() << endl;
+                return 1;
+            }
+            kmap->printSolution();
+        }
+    }
+    if (wantedStats != nullptr) {
+        cerr << wantedStats->json() << endl;
+    }
 };
\ No newline at end of file